@@ -1102,4 +1102,100 @@ void ADC::stopSynchronizedContinuous()
     adc1->stopContinuous();
 }
 
+#if defined(ADC_USE_PDB) || defined(ADC_USE_QUAD_TIMER)
+//! Sample one pin with both ADCs in turns
+/** Same timer for both ADCs, ADC1 delayed by phase of the period
+*
+*/
+bool ADC::startInterleaved(uint8_t pin, uint32_t freq, float phase)
+{
+    // check pin
+    if (!adc0->checkPin(pin))
+    {
+        adc0->fail_flag |= ADC_ERROR::WRONG_PIN;
+        return false;
+    }
+    if (!adc1->checkPin(pin))
+    {
+        adc1->fail_flag |= ADC_ERROR::WRONG_PIN;
+        return false;
+    }
+
+    // single conversions, one per trigger
+    adc0->startSingleRead(pin);
+    adc1->startSingleRead(pin);
+
+#if defined(ADC_USE_PDB)
+    if (freq & 1)
+    { // the PDB frequency is an integer, freq/2 would be rounded
+        adc1->fail_flag |= ADC_ERROR::OTHER;
+        return false;
+    }
+    if (!adc0->startPDB(freq / 2) || !adc1->startPDB(freq / 2))
+#else
+    if (!adc0->startQuadTimer(freq / 2.0) || !adc1->startQuadTimer(freq / 2.0))
+#endif
+    {
+        stopInterleaved();
+        return false;
+    }
+    if (!adc1->setTimerPhase(phase))
+    {
+        stopInterleaved();
+        return false;
+    }
+    return true;
+}
+
+//! Stop the time-interleaved conversions
+void ADC::stopInterleaved()
+{
+    adc0->stopTimer();
+    adc1->stopTimer();
+}
+#endif
+
+#endif
+
+#ifdef ADC_USE_PDB
+//! Start the pretriggers of the sequence in both ADCs
+/** Each ADC restarts the PDB with the same period, the last one starts
+*   the counter for both.
+*/
+bool ADC::startPDBSequence(const ADC_pdb::Sequence &sequence, uint32_t freq)
+{
+    // every step in an ADC of this board
+    for (uint8_t i = 0; i < sequence.stepNum(); i++)
+    {
+        if (sequence.step(i).adc_num >= ADC_NUM_ADCS)
+        {
+            adc0->fail_flag |= ADC_ERROR::OTHER;
+            return false;
+        }
+    }
+    if (sequence.stepNum() == 0)
+    {
+        adc0->fail_flag |= ADC_ERROR::OTHER;
+        return false;
+    }
+
+    for (int i = 0; i < ADC_NUM_ADCS; i++)
+    {
+        if (!adc[i]->startPDBSequence(sequence, freq))
+        {
+            stopPDBSequence();
+            return false;
+        }
+    }
+    return true;
+}
+
+//! Stop the PDB sequence
+void ADC::stopPDBSequence()
+{
+    for (int i = 0; i < ADC_NUM_ADCS; i++)
+    {
+        adc[i]->stopPDB();
+    }
+}
 #endif
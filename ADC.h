@@ -569,10 +569,58 @@ public:
   //! Stops synchronous continuous conversion
   void stopSynchronizedContinuous();
 
+#if defined(ADC_USE_PDB) || defined(ADC_USE_QUAD_TIMER)
+  ///////////// TIME-INTERLEAVED CONVERSION METHODS ////////////
+
+  //! Sample one pin with both ADCs in turns, at twice the rate of each one
+  /** Both ADCs are triggered by the same timer at freq/2, ADC1 delayed by
+   * phase of the period (setTimerPhase), so with phase 0.5 the conversions
+   * are evenly spaced at freq. Use AnalogBufferDMA::initSynchronized before
+   * to get them in order in the same buffers: adc0, adc1, adc0, ... and
+   * ADC_InterleaveCorrection (ADC_interleave.h) to match the gain and
+   * offset of both ADCs. Use the same settings in both ADCs.
+   * On Teensy 4 the delay is at most 437 us, so freq must be higher than
+   * about 2.3 kHz with phase 0.5. On Teensy 3.x the PDB frequency is an
+   * integer, so freq must be even.
+   *   \param pin pin valid in both ADCs
+   *   \param freq combined sample rate, each ADC converts at freq/2
+   *   \param phase delay of ADC1, as a fraction of the period of each ADC
+   *   \return false if the pin, frequency (odd on Teensy 3.x) or phase are
+   * not valid.
+   */
+  bool startInterleaved(uint8_t pin, uint32_t freq, float phase = 0.5);
+
+  //! Stop the time-interleaved conversions
+  void stopInterleaved();
+#endif
+
   ///@}
 
 #endif
 
+#ifdef ADC_USE_PDB
+  /** @name PDB sequence methods
+   */
+  ///@{
+
+  //! Convert up to four pins of both ADCs at fixed delays in each PDB period
+  /** Each step of the sequence is a pretrigger of the PDB, with its own delay
+   * from the start of the period or back to back with the previous one, see
+   * ADC_pdb::Sequence. Use the same settings in both ADCs. Read the results
+   * of pretrigger 0 with adc->adcX->readSingle() and of pretrigger 1 with
+   * adc->adcX->readSingleB(), or with AnalogBufferDMA::pingPongMode.
+   *   \param sequence the pins and delays.
+   *   \param freq frequency of the sequences.
+   *   \return false if the pins, frequency or delays are not valid.
+   */
+  bool startPDBSequence(const ADC_pdb::Sequence &sequence, uint32_t freq);
+
+  //! Stop the PDB sequence
+  void stopPDBSequence();
+
+  ///@}
+#endif
+
   //////////// ERRORS /////
   //! Resets all errors from all ADCs, if any.
   void resetError() {
@@ -986,6 +986,16 @@ bool ADC_Module::checkPin(uint8_t pin)
     return true;
 }
 
+// SC1A channel of the pin, including the mux information
+uint8_t ADC_Module::getSC1A(uint8_t pin)
+{
+    if (!checkPin(pin))
+    {
+        return ADC_SC1A_PIN_INVALID;
+    }
+    return channel2sc1a[pin] & (ADC_SC1A_CHANNELS | ADC_SC1A_PIN_MUX);
+}
+
 #if ADC_DIFF_PAIRS > 0
 // check whether the pins are a valid analog differential pins (including PGA if enabled)
 bool ADC_Module::checkDifferentialPins(uint8_t pinP, uint8_t pinN)
@@ -1049,13 +1059,34 @@ void ADC_Module::startReadFast(uint8_t pin)
 #endif
 
     // select pin for single-ended mode and start conversion, enable interrupts if requested
-    __disable_irq();
+    const uint32_t primask = atomic::disableInterrupts();
 #ifdef ADC_TEENSY_4
+    pin_channel = sc1a_pin & ADC_SC1A_CHANNELS;
     adc_regs.HC0 = (sc1a_pin & ADC_SC1A_CHANNELS) + interrupts_enabled * ADC_HC_AIEN;
 #else
     adc_regs.SC1A = (sc1a_pin & ADC_SC1A_CHANNELS) + atomic::getBitFlag(adc_regs.SC1A, ADC_SC1_AIEN) * ADC_SC1_AIEN;
 #endif
-    __enable_irq();
+    atomic::restoreInterrupts(primask);
+}
+
+// Changes the pin of the running conversions (continuous or hardware triggered)
+// Doesn't do any of the checks on the pin
+void ADC_Module::setTriggeredPin(uint8_t pin)
+{
+#ifdef ADC_TEENSY_4
+    // the QuadTimer triggers go through the ADC_ETC, HC0 just points to it
+    if ((adc_regs.HC0 & 0x1f) == 16)
+    {
+        const uint8_t sc1a_pin = channel2sc1a[pin] & ADC_SC1A_CHANNELS;
+        const uint32_t primask = atomic::disableInterrupts();
+        pin_channel = sc1a_pin;
+        IMXRT_ADC_ETC.TRIG[ADC_ETC_TRIGGER_INDEX].CHAIN_1_0 =
+            (IMXRT_ADC_ETC.TRIG[ADC_ETC_TRIGGER_INDEX].CHAIN_1_0 & ~ADC_ETC_TRIG_CHAIN_CSEL0(0xf)) | ADC_ETC_TRIG_CHAIN_CSEL0(sc1a_pin);
+        atomic::restoreInterrupts(primask);
+        return;
+    }
+#endif
+    startReadFast(pin);
 }
 
 #if ADC_DIFF_PAIRS > 0
@@ -1076,9 +1107,9 @@ void ADC_Module::startDifferentialFast(uint8_t pinP, uint8_t pinN)
     }
 #endif // ADC_USE_PGA
 
-    __disable_irq();
+    const uint32_t primask = atomic::disableInterrupts();
     adc_regs.SC1A = ADC_SC1_DIFF + (sc1a_pin & ADC_SC1A_CHANNELS) + atomic::getBitFlag(adc_regs.SC1A, ADC_SC1_AIEN) * ADC_SC1_AIEN;
-    __enable_irq();
+    atomic::restoreInterrupts(primask);
 }
 #endif
 
@@ -1451,117 +1482,157 @@ void ADC_Module::stopContinuous()
     return;
 }
 
-//////////// FREQUENCY METHODS ////////
-
-//////////// PDB ////////////////
-#ifdef ADC_USE_PDB
+#ifdef ADC_TEENSY_4
+//////////// HARDWARE SEQUENCE METHODS ////////
 
-// frequency in Hz
-void ADC_Module::startPDB(uint32_t freq)
+/* Preload the pins in the ADC_ETC chain of this ADC's trigger.
+* Segment i triggers HC(i+1), which takes the channel from the ADC_ETC (channel 16),
+* so the result of pin i ends up in R(i+1). The segments are back to back (B2B),
+* the last one sets the done flag of the trigger.
+*/
+bool ADC_Module::setSequence(const uint8_t *pins, uint8_t pin_num)
 {
-    if (!(SIM_SCGC6 & SIM_SCGC6_PDB))
-    {                               // setup PDB
-        SIM_SCGC6 |= SIM_SCGC6_PDB; // enable pdb clock
+    if ((pin_num == 0) || (pin_num > 7))
+    {
+        fail_flag |= ADC_ERROR::OTHER;
+        return false;
+    }
+    uint8_t channels[7];
+    for (uint8_t i = 0; i < pin_num; i++)
+    {
+        const uint8_t sc1a_pin = getSC1A(pins[i]);
+        if (sc1a_pin == ADC_SC1A_PIN_INVALID)
+        {
+            fail_flag |= ADC_ERROR::WRONG_PIN;
+            return false;
+        }
+        channels[i] = sc1a_pin & ADC_SC1A_CHANNELS;
     }
 
-    if (freq > ADC_F_BUS)
-        return; // too high
-    if (freq < 1)
-        return; // too low
+    if (calibrating)
+        wait_for_cal();
 
-    // mod will have to be a 16 bit value
-    // we detect if it's higher than 0xFFFF and scale it back accordingly.
-    uint32_t mod = (ADC_F_BUS / freq);
+    singleMode();
+    setHardwareTrigger();
+    volatile uint32_t *hc = &adc_regs.HC0;
+    for (uint8_t i = 1; i <= pin_num; i++)
+    {
+        hc[i] = 16; // ADC_ETC channel
+    }
 
-    uint8_t prescaler = 0; // from 0 to 7: factor of 1, 2, 4, 8, 16, 32, 64 or 128
-    uint8_t mult = 0;      // from 0 to 3, factor of 1, 10, 20 or 40
+    if (IMXRT_ADC_ETC.CTRL & ADC_ETC_CTRL_SOFTRST)
+    {
+        atomic::clearBitFlag(IMXRT_ADC_ETC.CTRL, ADC_ETC_CTRL_SOFTRST);
+        delay(5); // give some time to be sure it is init
+    }
+    // same routing as startQuadTimer
+    if (ADC_num == 0)
+    {
+        IMXRT_ADC_ETC.CTRL |= ADC_ETC_CTRL_TSC_BYPASS;
+    }
+    else
+    {
+        IMXRT_ADC_ETC.CTRL &= ~(ADC_ETC_CTRL_TSC_BYPASS);
+    }
 
-    // if mod is too high we need to use prescaler and mult to bring it down to a 16 bit number
-    const uint32_t min_level = 0xFFFF;
-    if (mod > min_level)
+    volatile uint32_t *chain = &IMXRT_ADC_ETC.TRIG[ADC_ETC_TRIGGER_INDEX].CHAIN_1_0;
+    for (uint8_t i = 0; i < pin_num; i += 2)
     {
-        if (mod < 2 * min_level)
-        {
-            prescaler = 1;
-        }
-        else if (mod < 4 * min_level)
-        {
-            prescaler = 2;
-        }
-        else if (mod < 8 * min_level)
-        {
-            prescaler = 3;
-        }
-        else if (mod < 10 * min_level)
-        {
-            mult = 1;
-        }
-        else if (mod < 16 * min_level)
-        {
-            prescaler = 4;
-        }
-        else if (mod < 20 * min_level)
-        {
-            mult = 2;
-        }
-        else if (mod < 32 * min_level)
+        uint32_t segments = 0;
+        for (uint8_t j = i; (j < i + 2) && (j < pin_num); j++)
         {
-            prescaler = 5;
-        }
-        else if (mod < 40 * min_level)
-        {
-            mult = 3;
-        }
-        else if (mod < 64 * min_level)
-        {
-            prescaler = 6;
-        }
-        else if (mod < 128 * min_level)
-        {
-            prescaler = 7;
-        }
-        else if (mod < 160 * min_level)
-        { // 16*10
-            prescaler = 4;
-            mult = 1;
-        }
-        else if (mod < 320 * min_level)
-        { // 16*20
-            prescaler = 4;
-            mult = 2;
-        }
-        else if (mod < 640 * min_level)
-        { // 16*40
-            prescaler = 4;
-            mult = 3;
-        }
-        else if (mod < 1280 * min_level)
-        { // 32*40
-            prescaler = 5;
-            mult = 3;
-        }
-        else if (mod < 2560 * min_level)
-        { // 64*40
-            prescaler = 6;
-            mult = 3;
-        }
-        else if (mod < 5120 * min_level)
-        { // 128*40
-            prescaler = 7;
-            mult = 3;
-        }
-        else
-        { // frequency too low
-            return;
+            uint32_t segment = ADC_ETC_TRIG_CHAIN_HWTS0(1 << (j + 1)) | ADC_ETC_TRIG_CHAIN_CSEL0(channels[j]);
+            segment |= (j < pin_num - 1) ? ADC_ETC_TRIG_CHAIN_B2B0 : ADC_ETC_TRIG_CHAIN_IE0(1);
+            segments |= segment << (16 * (j & 1));
         }
+        chain[i / 2] = segments;
+    }
+    // software triggered
+    IMXRT_ADC_ETC.TRIG[ADC_ETC_TRIGGER_INDEX].CTRL = ADC_ETC_TRIG_CTRL_TRIG_MODE | ADC_ETC_TRIG_CTRL_TRIG_CHAIN(pin_num - 1);
+    IMXRT_ADC_ETC.DONE0_1_IRQ = 1 << ADC_ETC_TRIGGER_INDEX; // clear the done flag
 
-        mod >>= prescaler;
-        if (mult > 0)
-        {
-            mod /= 10;
-            mod >>= (mult - 1);
+    sequence_num = pin_num;
+    sequence_started = false;
+    return true;
+}
+
+// Start the sequence, a single write
+bool ADC_Module::startSequence()
+{
+    if (sequence_num == 0)
+    {
+        fail_flag |= ADC_ERROR::OTHER;
+        return false;
+    }
+    IMXRT_ADC_ETC.DONE0_1_IRQ = 1 << ADC_ETC_TRIGGER_INDEX;
+    sequence_started = true;
+    IMXRT_ADC_ETC.TRIG[ADC_ETC_TRIGGER_INDEX].CTRL |= ADC_ETC_TRIG_CTRL_SW_TRIG;
+    return true;
+}
+
+// Wait for the sequence and copy R1..Rn, only if one was started, otherwise the done flag never comes
+uint8_t ADC_Module::readSequence(int *results)
+{
+    if ((sequence_num == 0) || !sequence_started)
+    {
+        return 0;
+    }
+    while (!isSequenceComplete())
+    {
+        if (!sequence_started)
+        { // stopSequence or another trigger took over the ADC_ETC
+            return 0;
         }
+        yield();
+    }
+    sequence_started = false;
+    volatile uint32_t *r = &adc_regs.R0;
+    for (uint8_t i = 0; i < sequence_num; i++)
+    {
+        results[i] = (uint16_t)r[i + 1];
+    }
+    IMXRT_ADC_ETC.DONE0_1_IRQ = 1 << ADC_ETC_TRIGGER_INDEX;
+    return sequence_num;
+}
+
+// Clear the chain and go back to software triggers
+void ADC_Module::stopSequence()
+{
+    IMXRT_ADC_ETC.TRIG[ADC_ETC_TRIGGER_INDEX].CTRL = 0;
+    IMXRT_ADC_ETC.TRIG[ADC_ETC_TRIGGER_INDEX].CHAIN_1_0 = 0;
+    IMXRT_ADC_ETC.TRIG[ADC_ETC_TRIGGER_INDEX].CHAIN_3_2 = 0;
+    IMXRT_ADC_ETC.TRIG[ADC_ETC_TRIGGER_INDEX].CHAIN_5_4 = 0;
+    IMXRT_ADC_ETC.TRIG[ADC_ETC_TRIGGER_INDEX].CHAIN_7_6 = 0;
+    setSoftwareTrigger();
+    sequence_num = 0;
+    sequence_started = false;
+}
+#endif
+
+//////////// FREQUENCY METHODS ////////
+
+//////////// PDB ////////////////
+#ifdef ADC_USE_PDB
+
+// frequency in Hz
+bool ADC_Module::startPDB(uint32_t freq)
+{
+    if (!(SIM_SCGC6 & SIM_SCGC6_PDB))
+    {                               // setup PDB
+        SIM_SCGC6 |= SIM_SCGC6_PDB; // enable pdb clock
+    }
+
+    // prescaler, mult and mod closest to the frequency
+    ADC_pdb::Setting setting = {};
+    if (!ADC_pdb::solve(ADC_F_BUS, freq, &setting))
+    { // too high or too low
+        fail_flag |= ADC_ERROR::OTHER;
+        return false;
     }
+    const uint8_t prescaler = setting.prescaler; // from 0 to 7: factor of 1, 2, 4, 8, 16, 32, 64 or 128
+    const uint8_t mult = setting.mult;           // from 0 to 3, factor of 1, 10, 20 or 40
+    const uint32_t mod = setting.mod;            // from 1 to 0x10000
+    pdb_frequency = freq;
 
     setHardwareTrigger(); // trigger ADC with hardware
 
@@ -1580,8 +1651,94 @@ void ADC_Module::startPDB(uint32_t freq)
     PDB0_SC = ADC_PDB_CONFIG | PDB_SC_PRESCALER(prescaler) | PDB_SC_MULT(mult) | PDB_SC_SWTRIG; // start the counter!
 
     PDB0_CHnC1 = PDB_CHnC1_TOS_1 | PDB_CHnC1_EN_1; // enable pretrigger 0 (SC1A)
+#ifdef ADC_DUAL_ADCS
+    (ADC_num ? PDB0_CH1DLY0 : PDB0_CH0DLY0) = 0; // no delay, see setPDBPhase
+#else
+    PDB0_CH0DLY0 = 0;
+#endif
 
     //NVIC_ENABLE_IRQ(IRQ_PDB);
+    return true;
+}
+
+// Is the PDB counting continuously with the setting?
+static bool pdbRunningWith(const ADC_pdb::Setting &setting)
+{
+    return (SIM_SCGC6 & SIM_SCGC6_PDB) && (PDB0_SC & PDB_SC_PDBEN) && (PDB0_SC & PDB_SC_CONT) &&
+           ((uint32_t)PDB0_MOD + 1 == setting.mod) && (((PDB0_SC & 0x7000) >> 12) == setting.prescaler) &&
+           (((PDB0_SC & 0xC) >> 2) == setting.mult);
+}
+
+// The PDB can be restarted if the other ADC doesn't use it
+bool ADC_Module::isPDBFrequencyAvailable(uint32_t freq)
+{
+    ADC_pdb::Setting setting = {};
+    if (!ADC_pdb::solve(ADC_F_BUS, freq, &setting))
+        return false;
+    if (!(SIM_SCGC6 & SIM_SCGC6_PDB) || !(PDB0_SC & PDB_SC_PDBEN) || pdbRunningWith(setting))
+        return true;
+#ifdef ADC_DUAL_ADCS
+    return !((ADC_num ? PDB0_CH0C1 : PDB0_CH1C1) & 0xFF); // pretriggers of the other ADC
+#else
+    return true;
+#endif
+}
+
+// Change the rate of this ADC without disturbing the other one
+bool ADC_Module::setPDBFrequency(uint32_t freq)
+{
+    if (!isPDBFrequencyAvailable(freq))
+    {
+        fail_flag |= ADC_ERROR::OTHER;
+        return false;
+    }
+    ADC_pdb::Setting setting = {};
+    ADC_pdb::solve(ADC_F_BUS, freq, &setting);
+    if (!pdbRunningWith(setting))
+    {
+        return startPDB(freq);
+    }
+
+    // already at that rate, keep the counter and the delays
+    pdb_frequency = freq;
+    constexpr uint32_t PDB_CHnC1_EN_1 = 0x01;
+    if (!(PDB0_CHnC1 & PDB_CHnC1_EN_1))
+    { // join the running PDB like startPDB would
+        constexpr uint32_t PDB_CHnC1_TOS_1 = 0x0100;
+        setHardwareTrigger();
+#ifdef ADC_DUAL_ADCS
+        (ADC_num ? PDB0_CH1DLY0 : PDB0_CH0DLY0) = 0;
+#else
+        PDB0_CH0DLY0 = 0;
+#endif
+        PDB0_CHnC1 = PDB_CHnC1_TOS_1 | PDB_CHnC1_EN_1;
+        PDB0_SC |= PDB_SC_LDOK;
+    }
+    return true;
+}
+
+// Delay pretrigger 0 of this ADC's PDB channel
+bool ADC_Module::setPDBPhase(float phase)
+{
+    if (!(PDB0_SC & PDB_SC_PDBEN) || !(phase >= 0) || !(phase < 1))
+    {
+        fail_flag |= ADC_ERROR::OTHER;
+        return false;
+    }
+    // the pretrigger happens when the counter is equal to the delay
+    const uint32_t counts = (uint32_t)PDB0_MOD + 1;
+    uint32_t delay = (uint32_t)(phase * counts + 0.5f);
+    if (delay > PDB0_MOD)
+    {
+        delay = PDB0_MOD;
+    }
+#ifdef ADC_DUAL_ADCS
+    (ADC_num ? PDB0_CH1DLY0 : PDB0_CH0DLY0) = (uint16_t)delay;
+#else
+    PDB0_CH0DLY0 = (uint16_t)delay;
+#endif
+    PDB0_SC |= PDB_SC_LDOK; // load the delay
+    return true;
 }
 
 void ADC_Module::stopPDB()
@@ -1597,15 +1754,208 @@ void ADC_Module::stopPDB()
     //NVIC_DISABLE_IRQ(IRQ_PDB);
 }
 
-//! Return the PDB's frequency
-uint32_t ADC_Module::getPDBFrequency()
+// Start the PDB with both pretriggers: SC1A at the start of each period and
+// SC1B after the delay (or back to back)
+bool ADC_Module::startPDBPingPong(uint8_t pinA, uint8_t pinB, uint32_t freq, uint32_t delay_us)
+{
+    const uint8_t sc1a_pinA = getSC1A(pinA);
+    const uint8_t sc1a_pinB = getSC1A(pinB);
+    if ((sc1a_pinA == ADC_SC1A_PIN_INVALID) || (sc1a_pinB == ADC_SC1A_PIN_INVALID) ||
+        ((sc1a_pinA ^ sc1a_pinB) & ADC_SC1A_PIN_MUX))
+    { // both channels use the same mux setting
+        fail_flag |= ADC_ERROR::WRONG_PIN;
+        return false;
+    }
+
+    startReadFast(pinA); // select the mux and SC1A
+    if (!startPDB(freq))
+    {
+        return false;
+    }
+    adc_regs.SC1B = sc1a_pinB & ADC_SC1A_CHANNELS;
+
+    constexpr uint32_t PDB_CHnC1_TOS_1 = 0x0100;
+    constexpr uint32_t PDB_CHnC1_EN_1 = 0x01;
+    constexpr uint32_t PDB_CHnC1_TOS_2 = 0x0200;
+    constexpr uint32_t PDB_CHnC1_EN_2 = 0x02;
+    constexpr uint32_t PDB_CHnC1_BB_2 = 0x020000;
+
+    if (delay_us == 0)
+    { // pretrigger 1 starts when the SC1A conversion is done
+        PDB0_CHnC1 = PDB_CHnC1_TOS_1 | PDB_CHnC1_EN_1 | PDB_CHnC1_EN_2 | PDB_CHnC1_BB_2;
+        return true;
+    }
+
+    // delay in PDB counter ticks, it must fit in the period
+    const uint8_t prescaler = (PDB0_SC & 0x7000) >> 12;
+    const uint8_t mult = (PDB0_SC & 0xC) >> 2;
+    const uint32_t divider = ADC_pdb::divider(prescaler, mult);
+    const uint64_t ticks = (uint64_t)delay_us * (ADC_F_BUS / divider) / 1000000;
+    if ((ticks == 0) || (ticks > PDB0_MOD))
+    {
+        stopPDB();
+        fail_flag |= ADC_ERROR::OTHER;
+        return false;
+    }
+#ifdef ADC_DUAL_ADCS
+    (ADC_num ? PDB0_CH1DLY1 : PDB0_CH0DLY1) = (uint16_t)ticks;
+#else
+    PDB0_CH0DLY1 = (uint16_t)ticks;
+#endif
+    PDB0_CHnC1 = PDB_CHnC1_TOS_1 | PDB_CHnC1_EN_1 | PDB_CHnC1_TOS_2 | PDB_CHnC1_EN_2;
+    PDB0_SC |= PDB_SC_LDOK; // load the delay
+    return true;
+}
+
+// Start the PDB with the pretriggers and delays of this ADC in the sequence
+bool ADC_Module::startPDBSequence(const ADC_pdb::Sequence &sequence, uint32_t freq)
+{
+    const ADC_pdb::Step *step_a = sequence.find(ADC_num, 0);
+    const ADC_pdb::Step *step_b = sequence.find(ADC_num, 1);
+    if (!step_a && !step_b)
+    { // not in the sequence, the pretriggers are off
+        if (SIM_SCGC6 & SIM_SCGC6_PDB)
+            PDB0_CHnC1 = 0;
+        return true;
+    }
+    const uint8_t sc1a_pinA = getSC1A(step_a ? step_a->pin : step_b->pin);
+    const uint8_t sc1a_pinB = getSC1A(step_b ? step_b->pin : step_a->pin);
+    if ((sc1a_pinA == ADC_SC1A_PIN_INVALID) || (sc1a_pinB == ADC_SC1A_PIN_INVALID) ||
+        ((sc1a_pinA ^ sc1a_pinB) & ADC_SC1A_PIN_MUX))
+    { // both channels use the same mux setting
+        fail_flag |= ADC_ERROR::WRONG_PIN;
+        return false;
+    }
+
+    startReadFast(step_a ? step_a->pin : step_b->pin); // select the mux and SC1A
+    if (!startPDB(freq))
+    {
+        return false;
+    }
+    adc_regs.SC1B = sc1a_pinB & ADC_SC1A_CHANNELS;
+
+    // the delays in counts of the period startPDB chose
+    ADC_pdb::Setting setting = {};
+    setting.prescaler = (PDB0_SC & 0x7000) >> 12;
+    setting.mult = (PDB0_SC & 0xC) >> 2;
+    setting.mod = (uint32_t)PDB0_MOD + 1;
+    ADC_pdb::SequenceRegisters regs = {};
+    if (!sequence.compile(ADC_F_BUS, setting, ADC_NUM_ADCS, &regs))
+    {
+        stopPDB();
+        fail_flag |= ADC_ERROR::OTHER;
+        return false;
+    }
+#ifdef ADC_DUAL_ADCS
+    (ADC_num ? PDB0_CH1DLY0 : PDB0_CH0DLY0) = regs.dly[ADC_num][0];
+    (ADC_num ? PDB0_CH1DLY1 : PDB0_CH0DLY1) = regs.dly[ADC_num][1];
+#else
+    PDB0_CH0DLY0 = regs.dly[0][0];
+    PDB0_CH0DLY1 = regs.dly[0][1];
+#endif
+    PDB0_CHnC1 = regs.c1[ADC_num];
+    PDB0_SC |= PDB_SC_LDOK; // load the delays
+    return true;
+}
+
+// One shot PDB started by the rising edges of PDB0_EXTRG, pretrigger 0 after the delay
+bool ADC_Module::startExternalTrigger(uint8_t pin, uint32_t delay_us)
+{
+    volatile uint32_t *pin_config;
+    if (pin == 11)
+    { // PTC6
+        pin_config = &CORE_PIN11_CONFIG;
+    }
+    else if (pin == 15)
+    { // PTC0
+        pin_config = &CORE_PIN15_CONFIG;
+    }
+    else
+    {
+        fail_flag |= ADC_ERROR::WRONG_PIN;
+        return false;
+    }
+
+    // smallest prescaler and mult with the delay in the 16 bit counter
+    uint8_t prescaler = 0, mult = 0;
+    uint64_t ticks = 0;
+    uint32_t best_divider = 0;
+    for (uint8_t p = 0; p < 8; p++)
+    {
+        for (uint8_t m = 0; m < 4; m++)
+        {
+            const uint32_t divider = ADC_pdb::divider(p, m);
+            const uint64_t t = (uint64_t)delay_us * (ADC_F_BUS / divider) / 1000000;
+            if ((t < 0xFFFF) && (!best_divider || (divider < best_divider)))
+            {
+                best_divider = divider;
+                prescaler = p;
+                mult = m;
+                ticks = t;
+            }
+        }
+    }
+    if (!best_divider)
+    { // too long
+        fail_flag |= ADC_ERROR::OTHER;
+        return false;
+    }
+
+    if (!(SIM_SCGC6 & SIM_SCGC6_PDB))
+    {                               // setup PDB
+        SIM_SCGC6 |= SIM_SCGC6_PDB; // enable pdb clock
+    }
+    *pin_config = PORT_PCR_MUX(3); // PDB0_EXTRG
+    pdb_frequency = 0;
+
+    setHardwareTrigger(); // trigger ADC with hardware
+
+    //                                   external trigger   enable PDB     one shot, load immediately
+    constexpr uint32_t ADC_PDB_CONFIG = PDB_SC_TRGSEL(0) | PDB_SC_PDBEN | PDB_SC_LDMOD(0);
+
+    constexpr uint32_t PDB_CHnC1_TOS_1 = 0x0100;
+    constexpr uint32_t PDB_CHnC1_EN_1 = 0x01;
+
+    PDB0_MOD = (uint16_t)(ticks + 1); // the counter stops soon after the pretrigger
+    PDB0_IDLY = (uint16_t)(ticks + 1);
+#ifdef ADC_DUAL_ADCS
+    (ADC_num ? PDB0_CH1DLY0 : PDB0_CH0DLY0) = (uint16_t)ticks;
+#else
+    PDB0_CH0DLY0 = (uint16_t)ticks;
+#endif
+    PDB0_CHnC1 = PDB_CHnC1_TOS_1 | PDB_CHnC1_EN_1; // enable pretrigger 0 (SC1A)
+
+    PDB0_SC = ADC_PDB_CONFIG | PDB_SC_PRESCALER(prescaler) | PDB_SC_MULT(mult) | PDB_SC_LDOK; // load all new values
+    return true;
+}
+
+// Counts of the bus clock per PDB period
+static uint32_t pdbPeriodTicks()
 {
     const uint32_t mod = (uint32_t)PDB0_MOD;
     const uint8_t prescaler = (PDB0_SC & 0x7000) >> 12;
     const uint8_t mult = (PDB0_SC & 0xC) >> 2;
 
-    const uint32_t freq = uint32_t((mod + 1) << (prescaler)) * uint32_t((mult == 0) ? 1 : 10 << (mult - 1));
-    return ADC_F_BUS / freq;
+    return (mod + 1) * ADC_pdb::divider(prescaler, mult);
+}
+
+//! Return the PDB's frequency, rounded
+uint32_t ADC_Module::getPDBFrequency()
+{
+    const uint32_t ticks = pdbPeriodTicks();
+    return (ADC_F_BUS + ticks / 2) / ticks;
+}
+
+//! Return the PDB's exact frequency
+double ADC_Module::getPDBExactFrequency()
+{
+    return (double)ADC_F_BUS / pdbPeriodTicks();
+}
+
+//! Difference between the PDB's frequency and the one requested
+double ADC_Module::getPDBFrequencyError()
+{
+    return getPDBExactFrequency() - pdb_frequency;
 }
 
 #endif
@@ -1618,19 +1968,77 @@ uint32_t ADC_Module::getPDBFrequency()
 extern "C"
 {
     extern void xbar_connect(unsigned int input, unsigned int output);
-    extern void quadtimer_init(IMXRT_TMR_t *p);
-    extern void quadtimerWrite(IMXRT_TMR_t *p, unsigned int submodule, uint16_t val);
-    extern void quadtimerFrequency(IMXRT_TMR_t *p, unsigned int submodule, float frequency);
 }
 
-void ADC_Module::startQuadTimer(uint32_t freq)
+// Set a QuadTimer channel to pulse once every period counts of the source
+static void quadTimerChannel(uint8_t channel, uint8_t pcs, uint32_t period)
+{
+    const uint32_t high = (period / 50) ? (period / 50) : 1; // short pulse
+    const uint32_t low = period - high;
+
+    // Extracted from quadtimer_init and quadtimerFrequency in pwm.c
+    IMXRT_TMR4.CH[channel].CTRL = 0; // stop timer
+    IMXRT_TMR4.CH[channel].CNTR = 0;
+    IMXRT_TMR4.CH[channel].SCTRL = TMR_SCTRL_OEN | TMR_SCTRL_OPS | TMR_SCTRL_VAL | TMR_SCTRL_FORCE;
+    IMXRT_TMR4.CH[channel].CSCTRL = TMR_CSCTRL_CL1(1) | TMR_CSCTRL_ALT_LOAD;
+    IMXRT_TMR4.CH[channel].LOAD = 65537 - low; // low time
+    IMXRT_TMR4.CH[channel].COMP1 = 0;
+    IMXRT_TMR4.CH[channel].CMPLD1 = high; // high time
+    IMXRT_TMR4.CH[channel].CTRL = TMR_CTRL_CM(1) | TMR_CTRL_PCS(pcs) |
+                                  TMR_CTRL_LENGTH | TMR_CTRL_OUTMODE(6);
+}
+
+// Period in counts of its source of a channel set by quadTimerChannel
+static uint32_t quadTimerChannelPeriod(uint8_t channel)
+{
+    return (65537 - IMXRT_TMR4.CH[channel].LOAD) + IMXRT_TMR4.CH[channel].CMPLD1;
+}
+
+// Program the timer channel of this ADC, counting the cascade channel if the setting has one
+void ADC_Module::quadTimerWrite(const ADC_quadtimer::Setting &setting)
+{
+    const uint8_t cascade_index = quadTimerCascadeIndex();
+    if (setting.cascade_period)
+    {
+        quadTimerChannel(cascade_index, 8 + setting.prescaler, setting.cascade_period);
+        quadTimerChannel(QTIMER4_INDEX, 4 + cascade_index, setting.period); // counts the cascade channel output
+    }
+    else
+    {
+        IMXRT_TMR4.CH[cascade_index].CTRL = 0;
+        quadTimerChannel(QTIMER4_INDEX, 8 + setting.prescaler, setting.period);
+    }
+}
+
+bool ADC_Module::startQuadTimer(double freq)
+{
+    // closest timer setting
+    ADC_quadtimer::Setting setting = {};
+    if (!ADC_quadtimer::solve(F_BUS_ACTUAL, freq, &setting))
+    {
+        fail_flag |= ADC_ERROR::OTHER;
+        return false;
+    }
+    quadtimer_frequency = freq;
+
+    startETCTrigger(XBAR_IN);
+    quadTimerWrite(setting);
+    return true;
+}
+
+// Route the XBAR input to the ADC_ETC trigger of this ADC, which converts the pin of startReadFast
+void ADC_Module::startETCTrigger(uint8_t xbar_input)
 {
     // First lets setup the XBAR
     CCM_CCGR2 |= CCM_CCGR2_XBAR1(CCM_CCGR_ON); //turn clock on for xbara1
-    xbar_connect(XBAR_IN, XBAR_OUT);
+    xbar_connect(xbar_input, XBAR_OUT);
 
     // Update the ADC
-    uint8_t adc_pin_channel = adc_regs.HC0 & 0x1f; // remember the trigger that was set
+    // HC0 may already point to the ADC_ETC (16) after another trigger, use the pin selected last
+    uint8_t adc_pin_channel = pin_channel;
+    // the chain below replaces any sequence of setSequence
+    sequence_num = 0;
+    sequence_started = false;
     setHardwareTrigger();                          // set the hardware trigger
     adc_regs.HC0 = (adc_regs.HC0 & ~0x1f) | 16;    // ADC_ETC channel remember other states...
     singleMode();                                  // make sure continuous is turned off as you want the trigger to di it.
@@ -1676,46 +2084,196 @@ void ADC_Module::startQuadTimer(uint32_t freq)
             IMXRT_ADC_ETC.DMA_CTRL |= ADC_ETC_DMA_CTRL_TRIQ_ENABLE(ADC_ETC_TRIGGER_INDEX);
         }
     }
+    IMXRT_ADC_ETC.TRIG[ADC_ETC_TRIGGER_INDEX].COUNTER = 0; // no delay, see setQuadTimerPhase
+}
+
+// Start the QuadTimer and convert a chain of pins back to back in each trigger
+bool ADC_Module::startQuadTimerChain(const uint8_t *pins, uint8_t pin_num, uint32_t freq)
+{
+    if ((pin_num == 0) || (pin_num > 8))
+    {
+        fail_flag |= ADC_ERROR::OTHER;
+        return false;
+    }
+    uint8_t channels[8];
+    for (uint8_t i = 0; i < pin_num; i++)
+    {
+        const uint8_t sc1a_pin = getSC1A(pins[i]);
+        if (sc1a_pin == ADC_SC1A_PIN_INVALID)
+        {
+            fail_flag |= ADC_ERROR::WRONG_PIN;
+            return false;
+        }
+        channels[i] = sc1a_pin & ADC_SC1A_CHANNELS;
+    }
+
+    if (!startQuadTimer(freq))
+    {
+        return false;
+    }
 
-    // Now init the QTimer.
-    // Extracted from quadtimer_init in pwm.c but only the one channel...
-    // Maybe see if we have to do this every time we call this.  But how often is that?
-    IMXRT_TMR4.CH[QTIMER4_INDEX].CTRL = 0; // stop timer
-    IMXRT_TMR4.CH[QTIMER4_INDEX].CNTR = 0;
-    IMXRT_TMR4.CH[QTIMER4_INDEX].SCTRL = TMR_SCTRL_OEN | TMR_SCTRL_OPS | TMR_SCTRL_VAL | TMR_SCTRL_FORCE;
-    IMXRT_TMR4.CH[QTIMER4_INDEX].CSCTRL = TMR_CSCTRL_CL1(1) | TMR_CSCTRL_ALT_LOAD;
-    // COMP must be less than LOAD - otherwise output is always low
-    IMXRT_TMR4.CH[QTIMER4_INDEX].LOAD = 24000; // low time  (65537 - x) -
-    IMXRT_TMR4.CH[QTIMER4_INDEX].COMP1 = 0;    // high time (0 = always low, max = LOAD-1)
-    IMXRT_TMR4.CH[QTIMER4_INDEX].CMPLD1 = 0;
-    IMXRT_TMR4.CH[QTIMER4_INDEX].CTRL = TMR_CTRL_CM(1) | TMR_CTRL_PCS(8) |
-                                        TMR_CTRL_LENGTH | TMR_CTRL_OUTMODE(6);
+    // each segment converts one pin in HC0 and starts the next one (B2B), the last one ends the chain
+    volatile uint32_t *chain = &IMXRT_ADC_ETC.TRIG[ADC_ETC_TRIGGER_INDEX].CHAIN_1_0;
+    for (uint8_t i = 0; i < pin_num; i += 2)
+    {
+        uint32_t segments = 0;
+        for (uint8_t j = i; (j < i + 2) && (j < pin_num); j++)
+        {
+            uint32_t segment = ADC_ETC_TRIG_CHAIN_HWTS0(1) | ADC_ETC_TRIG_CHAIN_CSEL0(channels[j]);
+            segment |= (j < pin_num - 1) ? ADC_ETC_TRIG_CHAIN_B2B0 : ADC_ETC_TRIG_CHAIN_IE0(1);
+            segments |= segment << (16 * (j & 1));
+        }
+        chain[i / 2] = segments;
+    }
+    IMXRT_ADC_ETC.TRIG[ADC_ETC_TRIGGER_INDEX].CTRL = ADC_ETC_TRIG_CTRL_TRIG_CHAIN(pin_num - 1);
+    return true;
+}
 
-    quadtimerFrequency(&IMXRT_TMR4, QTIMER4_INDEX, freq);
-    quadtimerWrite(&IMXRT_TMR4, QTIMER4_INDEX, 5);
+// Result of a segment of the chain, two 12 bit results per register
+int ADC_Module::readQuadTimerChain(uint8_t index)
+{
+    volatile uint32_t *result = &IMXRT_ADC_ETC.TRIG[ADC_ETC_TRIGGER_INDEX].RESULT_1_0;
+    return (result[(index & 7) / 2] >> (16 * (index & 1))) & 0xFFF;
 }
 
-//! Stop the PDB
+//! Stop the Quad timer
 void ADC_Module::stopQuadTimer()
 {
-    quadtimerWrite(&IMXRT_TMR4, QTIMER4_INDEX, 0);
+    IMXRT_TMR4.CH[QTIMER4_INDEX].CTRL = 0;
+    IMXRT_TMR4.CH[quadTimerCascadeIndex()].CTRL = 0;
     setSoftwareTrigger();
 }
 
-//! Return the PDB's frequency
+//! Change the frequency of the running Quad timer
+bool ADC_Module::setQuadTimerFrequency(double freq)
+{
+    ADC_quadtimer::Setting setting = {};
+    if (!ADC_quadtimer::solve(F_BUS_ACTUAL, freq, &setting))
+    {
+        fail_flag |= ADC_ERROR::OTHER;
+        return false;
+    }
+    quadtimer_frequency = freq;
+    quadTimerWrite(setting);
+    return true;
+}
+
+// Setting of a channel programmed by quadTimerWrite, from its registers
+static ADC_quadtimer::Setting quadTimerSetting(uint8_t channel)
+{
+    const uint8_t pcs = (IMXRT_TMR4.CH[channel].CTRL >> 9) & 0xF;
+    ADC_quadtimer::Setting setting = {};
+    setting.period = quadTimerChannelPeriod(channel);
+    if (pcs >= 8)
+    { // IP bus
+        setting.prescaler = pcs - 8;
+    }
+    else
+    { // cascade channel
+        const uint8_t cascade_index = pcs - 4;
+        setting.prescaler = ((IMXRT_TMR4.CH[cascade_index].CTRL >> 9) & 0xF) - 8;
+        setting.cascade_period = quadTimerChannelPeriod(cascade_index);
+    }
+    return setting;
+}
+
+//! Return the Quad timer's exact frequency, from the registers
+double ADC_Module::getQuadTimerExactFrequency()
+{
+    if (!(IMXRT_TMR4.CH[QTIMER4_INDEX].CTRL & TMR_CTRL_CM(7)))
+        return 0; // stopped
+
+    return ADC_quadtimer::frequency(F_BUS_ACTUAL, quadTimerSetting(QTIMER4_INDEX));
+}
+
+// Follow the timer of ADC0 (channel 0), the ADC_ETC trigger waits INIT_DELAY cycles
+bool ADC_Module::setQuadTimerPhase(float phase)
+{
+    if (!(IMXRT_TMR4.CH[0].CTRL & TMR_CTRL_CM(7)) || !(phase >= 0) || !(phase < 1))
+    {
+        fail_flag |= ADC_ERROR::OTHER;
+        return false;
+    }
+    const uint64_t delay = (uint64_t)(phase * ADC_quadtimer::ticks(quadTimerSetting(0)) + 0.5);
+    if (delay > 0xFFFF)
+    {
+        fail_flag |= ADC_ERROR::OTHER;
+        return false;
+    }
+    if (ADC_num != 0)
+    {
+        IMXRT_TMR4.CH[QTIMER4_INDEX].CTRL = 0;
+        IMXRT_TMR4.CH[quadTimerCascadeIndex()].CTRL = 0;
+        xbar_connect(XBARA1_IN_QTIMER4_TIMER0, XBAR_OUT);
+    }
+    IMXRT_ADC_ETC.TRIG[ADC_ETC_TRIGGER_INDEX].COUNTER = ADC_ETC_TRIG_COUNTER_INIT_DELAY(delay);
+    return true;
+}
+
+// Pins with an XBAR input, the same on Teensy 4.0 and 4.1
+struct ADC_XbarPin
+{
+    uint8_t pin;
+    uint8_t xbar_input;             // XBARA1_IN_IOMUX_XBAR_INOUTnn
+    uint8_t mux;                    // ALT of the pad
+    volatile uint32_t *pad;         // IOMUXC_SW_MUX_CTL_PAD
+    volatile uint32_t *select;      // daisy register, if more than one pad can be the input
+    uint8_t select_value;
+};
+static const ADC_XbarPin adc_xbar_pins[] = {
+    {0, XBARA1_IN_IOMUX_XBAR_INOUT17, 1, &IOMUXC_SW_MUX_CTL_PAD_GPIO_AD_B0_03, &IOMUXC_XBAR1_IN17_SELECT_INPUT, 1},
+    {1, XBARA1_IN_IOMUX_XBAR_INOUT16, 1, &IOMUXC_SW_MUX_CTL_PAD_GPIO_AD_B0_02, &IOMUXC_XBAR1_IN16_SELECT_INPUT, 0},
+    {2, XBARA1_IN_IOMUX_XBAR_INOUT06, 3, &IOMUXC_SW_MUX_CTL_PAD_GPIO_EMC_04, &IOMUXC_XBAR1_IN06_SELECT_INPUT, 0},
+    {3, XBARA1_IN_IOMUX_XBAR_INOUT07, 3, &IOMUXC_SW_MUX_CTL_PAD_GPIO_EMC_05, &IOMUXC_XBAR1_IN07_SELECT_INPUT, 0},
+    {4, XBARA1_IN_IOMUX_XBAR_INOUT08, 3, &IOMUXC_SW_MUX_CTL_PAD_GPIO_EMC_06, &IOMUXC_XBAR1_IN08_SELECT_INPUT, 0},
+    {5, XBARA1_IN_IOMUX_XBAR_INOUT17, 3, &IOMUXC_SW_MUX_CTL_PAD_GPIO_EMC_08, &IOMUXC_XBAR1_IN17_SELECT_INPUT, 0},
+    {7, XBARA1_IN_IOMUX_XBAR_INOUT15, 1, &IOMUXC_SW_MUX_CTL_PAD_GPIO_B1_01, &IOMUXC_XBAR1_IN15_SELECT_INPUT, 1},
+    {8, XBARA1_IN_IOMUX_XBAR_INOUT14, 1, &IOMUXC_SW_MUX_CTL_PAD_GPIO_B1_00, &IOMUXC_XBAR1_IN14_SELECT_INPUT, 1},
+};
+
+// Trigger the ADC_ETC of this ADC with the edges of the pin instead of the QuadTimer
+bool ADC_Module::startExternalTrigger(uint8_t pin, uint32_t delay_us)
+{
+    const ADC_XbarPin *xbar_pin = nullptr;
+    for (const ADC_XbarPin &p : adc_xbar_pins)
+    {
+        if (p.pin == pin)
+            xbar_pin = &p;
+    }
+    const uint64_t delay = (uint64_t)delay_us * F_BUS_ACTUAL / 1000000;
+    if (!xbar_pin || (delay > 0xFFFF))
+    {
+        fail_flag |= ADC_ERROR::OTHER;
+        return false;
+    }
+
+    pinMode(pin, INPUT);
+    *xbar_pin->pad = xbar_pin->mux;
+    *xbar_pin->select = xbar_pin->select_value;
+    IOMUXC_GPR_GPR6 &= ~(1u << (12 + xbar_pin->xbar_input)); // XBAR_DIR_SEL: the pad is an input
+
+    stopQuadTimer(); // the pin replaces the timer
+    startETCTrigger(xbar_pin->xbar_input);
+    IMXRT_ADC_ETC.TRIG[ADC_ETC_TRIGGER_INDEX].COUNTER = ADC_ETC_TRIG_COUNTER_INIT_DELAY(delay);
+    return true;
+}
+
+void ADC_Module::stopExternalTrigger()
+{
+    xbar_connect(XBARA1_IN_LOGIC_LOW, XBAR_OUT);
+    setSoftwareTrigger();
+}
+
+//! Return the Quad timer's frequency, rounded
 uint32_t ADC_Module::getQuadTimerFrequency()
 {
-    // Can I reverse the calculations of quad timer set frequency?
-    uint32_t high = IMXRT_TMR4.CH[QTIMER4_INDEX].CMPLD1;
-    uint32_t low = 65537 - IMXRT_TMR4.CH[QTIMER4_INDEX].LOAD;
-    uint32_t highPlusLow = high + low; //
-    if (highPlusLow == 0)
-        return 0; //
-
-    uint8_t pcs = (IMXRT_TMR4.CH[QTIMER4_INDEX].CTRL >> 9) & 0x7;
-    uint32_t freq = (F_BUS_ACTUAL >> pcs) / highPlusLow;
-    //Serial.printf("ADC_Module::getTimerFrequency H:%u L:%u H+L=%u pcs:%u freq:%u\n", high, low, highPlusLow, pcs, freq);
-    return freq;
+    return (uint32_t)(getQuadTimerExactFrequency() + 0.5);
+}
+
+//! Difference between the Quad timer's frequency and the one requested
+double ADC_Module::getQuadTimerFrequencyError()
+{
+    return getQuadTimerExactFrequency() - quadtimer_frequency;
 }
 
 #endif // Teensy 4
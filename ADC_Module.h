@@ -40,6 +40,13 @@
 #include <atomic.h>
 #include <settings_defines.h>
 
+#ifdef ADC_TEENSY_4
+#include <ADC_quadtimer.h>
+#endif
+#ifdef ADC_USE_PDB
+#include <ADC_pdb.h>
+#endif
+
 using ADC_Error::ADC_ERROR;
 using namespace ADC_settings;
 
@@ -391,6 +398,17 @@ public:
    */
   bool checkPin(uint8_t pin);
 
+  /**
+   * @brief SC1A (HC0 on Teensy 4) channel of the pin
+   *
+   * Useful to start conversions with DMA. The ADC_SC1A_PIN_MUX bit
+   * indicates whether the pin uses mux a on Teensy 3.x.
+   * @param pin to translate.
+   * @return the channel with the mux bit, or ADC_SC1A_PIN_INVALID if the pin
+   * can't be read by this ADC.
+   */
+  uint8_t getSC1A(uint8_t pin);
+
   //!
   /**
    * @brief Check whether the pins are a valid analog differential pair of pins
@@ -418,6 +436,15 @@ public:
    */
   void startReadFast(uint8_t pin); // helper method
 
+  /**
+   * @brief Changes the pin converted by the running conversions
+   *
+   * Like startReadFast, but on Teensy 4 when the QuadTimer triggers the ADC
+   * through the ADC_ETC it changes the pin of the trigger chain instead.
+   * @param pin to read.
+   */
+  void setTriggeredPin(uint8_t pin);
+
 #if ADC_DIFF_PAIRS > 0
   /**
    * @brief Starts a differential conversion on the pair of pins
@@ -573,6 +600,64 @@ public:
 
   ///@}
 
+#ifdef ADC_TEENSY_4
+  ///////////// HARDWARE SEQUENCE METHODS ////////////
+  /** @name Hardware sequence methods (Teensy 4)
+   */
+  ///@{
+
+  /**
+   * @brief Preload a sequence of up to 7 pins.
+   * The pins are set once in the ADC_ETC trigger of this ADC and each one
+   * uses its own control and result registers (HC1-HC7, R1-R7), so starting
+   * the sequence is a single register write and the pins are converted back
+   * to back without rewriting HC0 for each one.
+   * It uses the same ADC_ETC trigger as the QuadTimer, don't use both at the
+   * same time.
+   * @param pins list of pin_num pins.
+   * @param pin_num number of pins, from 1 to 7.
+   * @return false if the pins are not valid.
+   */
+  bool setSequence(const uint8_t *pins, uint8_t pin_num);
+
+  /**
+   * @brief Start a conversion of the sequence set with @ref setSequence.
+   * It returns immediately, get the values with @ref readSequence.
+   * @return false if there's no sequence.
+   */
+  bool startSequence();
+
+  //! Is the last sequence started done?
+  bool isSequenceComplete() {
+    return IMXRT_ADC_ETC.DONE0_1_IRQ & (1 << ADC_ETC_TRIGGER_INDEX);
+  }
+
+  /**
+   * @brief Wait until the sequence is done and copy the results.
+   * It doesn't wait if no sequence was started with @ref startSequence since
+   * the last read, or if it was replaced by another ADC_ETC trigger.
+   * @param results array with space for a result per pin of the sequence, in
+   * the same order.
+   * @return the number of results, 0 if no sequence was started.
+   */
+  uint8_t readSequence(int *results);
+
+  /**
+   * @brief Convert the sequence set with @ref setSequence and copy the
+   * results. It waits until it's done.
+   * @param results array with space for a result per pin of the sequence.
+   * @return the number of results, 0 if there's no sequence.
+   */
+  uint8_t analogReadSequence(int *results) {
+    return startSequence() ? readSequence(results) : 0;
+  }
+
+  //! Remove the sequence and go back to software triggers
+  void stopSequence();
+
+  ///@}
+#endif
+
   //////////// FREQUENCY METHODS ////////
   // The general API is:
   // void startTimer(uint32_t freq)
@@ -601,10 +686,49 @@ public:
   //! Start PDB triggering the ADC at the frequency
   /** Call startSingleRead or startSingleDifferential on the pin that you want
    * to measure before calling this function. See the example adc_pdb.ino.
+   * The prescaler, multiplier and modulus are the ones closest to freq, see
+   * getPDBExactFrequency() for the frequency you get.
    *   \param freq is the frequency of the ADC conversion, it can't be lower
-   * that 1 Hz
+   * that 1 Hz or higher than the bus frequency
+   *   \return false if the frequency is out of range.
+   */
+  bool startPDB(uint32_t freq);
+
+  //! Change the frequency of the running default timer (PDB)
+  /** \return false if the frequency can't be set, see setPDBFrequency.
+   */
+  bool setTimerFrequency(uint32_t freq) __attribute__((always_inline)) {
+    return setPDBFrequency(freq);
+  }
+  //! Can the default timer (PDB) of this ADC change to freq?
+  bool isTimerFrequencyAvailable(uint32_t freq)
+      __attribute__((always_inline)) {
+    return isPDBFrequencyAvailable(freq);
+  }
+  //! Change the frequency of the PDB triggering this ADC
+  /** The PDB is shared by both ADCs. If it already runs at the setting of
+   * freq it isn't restarted, so the other ADC keeps its timing and its
+   * setPDBPhase delay. Otherwise it's restarted with startPDB, which is
+   * refused while the other ADC is triggered by the PDB too.
+   *   \return false if the frequency is out of range or would change the
+   * rate of the other ADC.
+   */
+  bool setPDBFrequency(uint32_t freq);
+  //! Can setPDBFrequency change to freq without changing the other ADC?
+  bool isPDBFrequencyAvailable(uint32_t freq);
+
+  //! Delay the conversions of this ADC by a fraction of the timer period
+  bool setTimerPhase(float phase) __attribute__((always_inline)) {
+    return setPDBPhase(phase);
+  }
+  //! Delay the PDB pretrigger of this ADC by a fraction of the PDB period
+  /** The PDB is shared by both ADCs, so with the same period the conversions
+   * of one ADC can be placed anywhere in the period of the other one. Call it
+   * after startPDB.
+   *   \param phase from 0 (no delay) to 1 (not included)
+   *   \return false if the PDB isn't running or the phase is out of range.
    */
-  void startPDB(uint32_t freq);
+  bool setPDBPhase(float phase);
 
   //! Stop the default timer (PDB)
   void stopTimer() __attribute__((always_inline)) { stopPDB(); }
@@ -620,10 +744,64 @@ public:
   }
   //! Return the PDB's frequency
   /** Return the PDB's frequency
-   *   \return the timer's frequency in Hz.
+   *   \return the timer's frequency in Hz, rounded.
    */
   uint32_t getPDBFrequency();
 
+  //! Return the PDB's frequency, as configured in the registers
+  double getPDBExactFrequency();
+
+  //! Return the PDB's frequency minus the one requested in startPDB, in Hz
+  double getPDBFrequencyError();
+
+  //! Start the PDB triggering two conversions each period, pinA and pinB
+  /** pinA is converted through SC1A and pretrigger 0 as with startPDB, and
+   * pinB through SC1B and pretrigger 1, delay_us after pinA or as soon as
+   * pinA is done if delay_us is 0. Both pins must use the same mux (a or b).
+   * Read the results with readSingle() and readSingleB(), or with
+   * AnalogBufferDMA::pingPongMode.
+   *   \param freq is the frequency of the pairs of conversions
+   *   \return false if the pins, frequency or delay are not valid.
+   */
+  bool startPDBPingPong(uint8_t pinA, uint8_t pinB, uint32_t freq,
+                        uint32_t delay_us = 0);
+
+  //! Is the SC1B conversion of startPDBPingPong ready?
+  volatile bool isCompleteB() __attribute__((always_inline)) {
+    return atomic::getBitFlag(adc_regs.SC1B, ADC_SC1_COCO);
+  }
+
+  //! Result of the SC1B conversion of startPDBPingPong
+  int readSingleB() __attribute__((always_inline)) {
+    return (int16_t)(int32_t)adc_regs.RB;
+  }
+
+  //! Start the PDB converting the steps of the sequence of this ADC
+  /** Sets the pins of the pretriggers of this ADC in SC1A and SC1B, starts
+   * the PDB and writes the delays of its channel. The PDB is shared by both
+   * ADCs, use ADC::startPDBSequence to start the sequence in both. Read the
+   * results with readSingle() (pretrigger 0) and readSingleB() (pretrigger 1).
+   *   \param freq is the frequency of the sequences
+   *   \return false if the pins, frequency or delays are not valid.
+   */
+  bool startPDBSequence(const ADC_pdb::Sequence &sequence, uint32_t freq);
+
+  //! Trigger the ADC at each rising edge of a pin, through the PDB
+  /** The pin is the external trigger input of the PDB (PDB0_EXTRG). Each
+   * rising edge starts the PDB once and it triggers the conversion delay_us
+   * later, so there's no interrupt per sample. Call startSingleRead or
+   * startSingleDifferential on the pin that you want to measure before, the
+   * results can be read as with startPDB, also with AnalogBufferDMA. The PDB
+   * is shared by both ADCs, call it on both to convert with each edge.
+   *   \param pin 11 or 15.
+   *   \param delay_us from the edge to the conversion, up to a few seconds.
+   *   \return false if the pin can't trigger the PDB or the delay is too
+   * long.
+   */
+  bool startExternalTrigger(uint8_t pin, uint32_t delay_us = 0);
+  //! Stop the external trigger, the same as stopPDB
+  void stopExternalTrigger() __attribute__((always_inline)) { stopPDB(); }
+
 //////////// TIMER ////////////////
 //// Only works for Teensy 3.x and 4 (not LC)
 #elif defined(ADC_USE_QUAD_TIMER)
@@ -640,10 +818,64 @@ public:
   //! Start a Quad timer to trigger the ADC at the frequency
   /** Call startSingleRead or startSingleDifferential on the pin that you want
    * to measure before calling this function. See the example adc_timer.ino.
-   *   \param freq is the frequency of the ADC conversion, it can't be lower
-   * that 1 Hz
+   * Each ADC has its own timer channel. The periods are the ones closest to
+   * freq, see getQuadTimerExactFrequency() for the frequency you get. Below
+   * about 18 Hz a second channel is cascaded, down to well below 1 Hz.
+   *   \param freq is the frequency of the ADC conversion, in Hz
+   *   \return false if the frequency is out of range.
+   */
+  bool startQuadTimer(double freq);
+
+  //! Start a Quad timer to trigger a chain of conversions of up to 8 pins
+  /** Each tick the ADC_ETC converts all the pins back to back and keeps the
+   * results in its result registers, read them with readQuadTimerChain() or
+   * with AnalogBufferDMA::chainMode.
+   *   \param pins list of pin_num pins of this ADC, from 1 to 8
+   *   \param freq is the frequency of the chains of conversions
+   *   \return false if the pins are not valid.
    */
-  void startQuadTimer(uint32_t freq);
+  bool startQuadTimerChain(const uint8_t *pins, uint8_t pin_num, uint32_t freq);
+
+  //! Result of the pin index of the chain of startQuadTimerChain
+  int readQuadTimerChain(uint8_t index);
+
+  //! Change the frequency of the running default timer (QuadTimer)
+  /** \return false if the frequency is out of range.
+   */
+  bool setTimerFrequency(uint32_t freq) __attribute__((always_inline)) {
+    return setQuadTimerFrequency(freq);
+  }
+  //! Can the default timer (QuadTimer) of this ADC change to freq?
+  /** Each ADC has its own QuadTimer, so only the range is checked.
+   */
+  bool isTimerFrequencyAvailable(uint32_t freq)
+      __attribute__((always_inline)) {
+    ADC_quadtimer::Setting setting = {};
+    return ADC_quadtimer::solve(F_BUS_ACTUAL, freq, &setting);
+  }
+
+  //! Delay the conversions of this ADC by a fraction of the timer period
+  bool setTimerPhase(float phase) __attribute__((always_inline)) {
+    return setQuadTimerPhase(phase);
+  }
+  //! Trigger this ADC with the Quad timer of ADC0, delayed by a fraction of
+  //! its period
+  /** The ADC_ETC trigger of this ADC waits phase of the period (its
+   * INIT_DELAY) after each tick of the timer of ADC0. ADC1 stops its own
+   * timer and follows the one of ADC0, so getQuadTimerFrequency() of ADC1
+   * returns 0. The delay is at most 65535 bus cycles (437 us at 150 MHz).
+   * Call it after startQuadTimer on both ADCs.
+   *   \param phase from 0 (no delay) to 1 (not included)
+   *   \return false if the timer of ADC0 isn't running or the delay is out
+   * of range.
+   */
+  bool setQuadTimerPhase(float phase);
+  //! Change the frequency of the running Quad timer
+  /** Unlike startQuadTimer it doesn't touch the ADC or the ADC_ETC.
+   *   \param freq is the new frequency of the ADC conversion
+   *   \return false if the frequency is out of range.
+   */
+  bool setQuadTimerFrequency(double freq);
 
   //! Stop the default timer (QuadTimer)
   void stopTimer() __attribute__((always_inline)) { stopQuadTimer(); }
@@ -659,9 +891,31 @@ public:
   }
   //! Return the Quad timer's frequency
   /** Return the Quad timer's frequency
-   *   \return the timer's frequency in Hz.
+   *   \return the timer's frequency in Hz, rounded.
    */
   uint32_t getQuadTimerFrequency();
+
+  //! Return the Quad timer's frequency, as configured in the registers
+  double getQuadTimerExactFrequency();
+
+  //! Return the Quad timer's frequency minus the one requested, in Hz
+  double getQuadTimerFrequencyError();
+
+  //! Trigger the ADC at each rising edge of a pin, through the XBAR
+  /** The pin is connected by the XBAR to the ADC_ETC trigger of this ADC,
+   * instead of the QuadTimer, so there's no interrupt per sample. The
+   * trigger waits delay_us (its INIT_DELAY) after each edge, at most 65535
+   * bus cycles (437 us at 150 MHz). Call startSingleRead on the pin that you
+   * want to measure before, the results can be read as with startQuadTimer,
+   * also with AnalogBufferDMA. Call it on both ADCs with the same pin to
+   * convert with both at each edge.
+   *   \param pin 0, 1, 2, 3, 4, 5, 7 or 8.
+   *   \param delay_us from the edge to the conversion.
+   *   \return false if the pin has no XBAR input or the delay is too long.
+   */
+  bool startExternalTrigger(uint8_t pin, uint32_t delay_us = 0);
+  //! Disconnect the pin and go back to software triggers
+  void stopExternalTrigger();
 #endif
 
   ///@}
@@ -824,12 +1078,29 @@ private:
 
 #ifdef ADC_USE_PDB
   reg PDB0_CHnC1; // PDB channel 0 or 1
+  // frequency requested in startPDB
+  uint32_t pdb_frequency = 0;
 #endif
 #ifdef ADC_TEENSY_4
   uint8_t XBAR_IN;
   uint8_t XBAR_OUT;
   uint8_t QTIMER4_INDEX;
   uint8_t ADC_ETC_TRIGGER_INDEX;
+  // frequency requested in startQuadTimer
+  double quadtimer_frequency = 0;
+  // QuadTimer channel cascaded for the low frequencies
+  uint8_t quadTimerCascadeIndex() { return (ADC_num == 0) ? 1 : 2; }
+  // Connect an XBAR input to the ADC_ETC trigger of this ADC
+  void startETCTrigger(uint8_t xbar_input);
+  // program the timer channels
+  void quadTimerWrite(const ADC_quadtimer::Setting &setting);
+  // number of pins of setSequence
+  uint8_t sequence_num = 0;
+  // startSequence was called and readSequence didn't read it yet
+  volatile bool sequence_started = false;
+  // channel of the last pin of startReadFast or setTriggeredPin, HC0 points
+  // to the ADC_ETC (16) while a trigger converts it
+  uint8_t pin_channel = ADC_SC1A_PIN_INVALID;
 #endif
   const IRQ_NUMBER_t IRQ_ADC; // IRQ number
 
@@ -0,0 +1,151 @@
+/* Teensy 4.x, 3.x, LC ADC library
+ * https://github.com/pedvide/ADC
+ * Copyright (c) 2020 Pedro Villanueva
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @page interleave ADC interleave
+ * Gain and offset correction of time-interleaved samples.
+ * ADC::startInterleaved samples one pin with both ADCs half a period apart
+ * and AnalogBufferDMA::initSynchronized merges them in order, but the two
+ * ADCs don't have exactly the same gain and offset, which shows up as a
+ * spur at half the sample rate. ADC_InterleaveCorrection estimates the
+ * mismatch from the buffers and corrects the ADC1 samples to match ADC0.
+ */
+
+#ifndef ADC_INTERLEAVE_H
+#define ADC_INTERLEAVE_H
+
+#include <math.h>
+#include <stdint.h>
+
+/**
+ * @brief Estimate and correct the gain and offset of ADC1 relative to ADC0
+ * in buffers of interleaved samples: adc0, adc1, adc0, ...
+ *
+ * Both ADCs sample the same signal, so over enough samples both halves have
+ * the same mean and variance. The correction maps the ADC1 samples x to
+ * (x - mean1) * std0 / std1 + mean0, in fixed point so it's fast on all the
+ * boards.
+ */
+class ADC_InterleaveCorrection {
+public:
+  /**
+   * @param max_value largest sample value, the corrected samples are clamped
+   * to it (4095 for 12 bits).
+   */
+  explicit ADC_InterleaveCorrection(uint16_t max_value = 0xFFFF)
+      : max_value(max_value) {
+    reset();
+  }
+
+  //! Forget the samples accumulated and go back to no correction
+  void reset() {
+    n = 0;
+    sum0 = sum1 = 0;
+    sum_sq0 = sum_sq1 = 0;
+    gain_q16 = 1 << 16;
+    offset_q16 = 0;
+  }
+
+  //! Add the (uncorrected) pairs of the buffer to the estimate
+  void accumulate(const volatile uint16_t *buffer, uint16_t count) {
+    for (uint16_t i = 0; i + 1 < count; i += 2) {
+      const uint32_t x0 = buffer[i];
+      const uint32_t x1 = buffer[i + 1];
+      sum0 += x0;
+      sum1 += x1;
+      sum_sq0 += x0 * x0;
+      sum_sq1 += x1 * x1;
+    }
+    n += count / 2;
+  }
+
+  /**
+   * @brief Compute the correction from the samples accumulated.
+   * @param min_pairs pairs needed for an estimate.
+   * @return false if there aren't enough pairs or ADC1 saw a constant
+   * signal, the correction doesn't change then.
+   */
+  bool estimate(uint32_t min_pairs = 1024) {
+    if ((n == 0) || (n < min_pairs)) {
+      return false;
+    }
+    const double mean0 = (double)sum0 / n;
+    const double mean1 = (double)sum1 / n;
+    const double var0 = (double)sum_sq0 / n - mean0 * mean0;
+    const double var1 = (double)sum_sq1 / n - mean1 * mean1;
+    if (!(var1 > 0) || !(var0 > 0)) {
+      return false;
+    }
+    const double gain = sqrt(var0 / var1);
+    gain_q16 = (int32_t)(gain * 65536 + 0.5);
+    offset_q16 = (int64_t)((mean0 - mean1 * gain) * 65536);
+    return true;
+  }
+
+  //! Set the correction directly, for example from a calibration
+  void setCorrection(float gain, float offset) {
+    gain_q16 = (int32_t)(gain * 65536 + 0.5f);
+    offset_q16 = (int64_t)(offset * 65536);
+  }
+
+  //! Copy the buffer to output with the ADC1 samples (odd indexes) corrected
+  /** The DMA buffer isn't written, on Teensy 4 writing it would leave dirty
+   * cache lines that could overwrite the next DMA transfers into it.
+   */
+  void correct(const volatile uint16_t *buffer, uint16_t *output,
+               uint16_t count) const {
+    for (uint16_t i = 0; i < count; i++) {
+      if (!(i & 1)) {
+        output[i] = buffer[i];
+        continue;
+      }
+      int64_t value =
+          ((int64_t)buffer[i] * gain_q16 + offset_q16 + (1 << 15)) >> 16;
+      if (value < 0) {
+        value = 0;
+      } else if (value > max_value) {
+        value = max_value;
+      }
+      output[i] = (uint16_t)value;
+    }
+  }
+
+  //! Gain applied to ADC1, std(ADC0) / std(ADC1)
+  float gain() const { return gain_q16 / 65536.0f; }
+  //! Offset added to ADC1 after the gain, in counts
+  float offset() const { return offset_q16 / 65536.0f; }
+  //! Pairs accumulated
+  uint32_t pairs() const { return n; }
+
+private:
+  uint16_t max_value;
+  uint32_t n;
+  uint64_t sum0, sum1;
+  uint64_t sum_sq0, sum_sq1;
+  int32_t gain_q16;
+  int64_t offset_q16;
+};
+
+#endif // ADC_INTERLEAVE_H
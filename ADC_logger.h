@@ -0,0 +1,224 @@
+/* Teensy 4.x, 3.x, LC ADC library
+ * https://github.com/pedvide/ADC
+ * Copyright (c) 2020 Pedro Villanueva
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @page logger ADC sector logger
+ * Logs samples to a preallocated contiguous area of a block device (the
+ * sectors of a preallocated file in an SD card) with whole sector writes.
+ * The samples are queued in RAM so the card can stall without losing any.
+ * It only depends on the block device, so it also runs on a computer, see
+ * extras/adc_logger.
+ */
+
+#ifndef ADC_LOGGER_H
+#define ADC_LOGGER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * @brief Queue of samples written to consecutive sectors of a block device.
+ *
+ * The producer (for example an AnalogBufferDMA callback, in the DMA ISR)
+ * pushes the samples into the queue and the consumer (loop) writes them.
+ * There can only be one of each, neither needs to disable interrupts.
+ * The queue must be big enough to hold the samples produced during the
+ * longest write, maxQueueDepth() tells how much of it was needed.
+ *
+ * @tparam BlockDevice has
+ * `bool writeSectors(uint32_t sector, const uint8_t *src, size_t count)`,
+ * like the SdFat SdCard (`SD.sdfs.card()` in Teensyduino).
+ */
+template <class BlockDevice> class ADC_SectorLogger {
+public:
+  //! Bytes per sector
+  static const uint32_t SECTOR_SIZE = 512;
+
+  /**
+   * @brief Constructor
+   * @param device block device to write to.
+   * @param queue memory for the queue, queue_sectors * SECTOR_SIZE bytes.
+   * @param queue_sectors size of the queue in sectors.
+   */
+  ADC_SectorLogger(BlockDevice &device, uint8_t *queue, uint32_t queue_sectors)
+      : device(device), queue(queue), queue_size(queue_sectors * SECTOR_SIZE) {}
+
+  /**
+   * @brief Start logging to sector_count sectors from first_sector
+   *
+   * Use the contiguous range of a preallocated file.
+   */
+  void begin(uint32_t first_sector, uint32_t sector_count) {
+    first = first_sector;
+    sectors = sector_count;
+    written = 0;
+    head = 0;
+    tail = 0;
+    max_depth = 0;
+    dropped = 0;
+    padding = 0;
+    error = false;
+  }
+
+  /**
+   * @brief Queue the samples, call it from the producer
+   * @return false if they didn't fit in the queue or the file, they are
+   * dropped.
+   */
+  bool push(const volatile uint16_t *samples, uint32_t count) {
+    uint32_t bytes = count * 2;
+    uint32_t h = head;
+    uint32_t depth = distance(tail, h);
+    uint64_t logged = (uint64_t)written * SECTOR_SIZE;
+    if ((depth + bytes > queue_size) || (logged + depth + bytes > (uint64_t)sectors * SECTOR_SIZE)) {
+      dropped += count;
+      return false;
+    }
+    uint32_t pos = h % queue_size;
+    uint32_t first_part = queue_size - pos;
+    if (first_part > bytes) {
+      first_part = bytes;
+    }
+    memcpy(queue + pos, (const void *)samples, first_part);
+    memcpy(queue, (const uint8_t *)samples + first_part, bytes - first_part);
+    __sync_synchronize(); // the samples are in the queue before they're published
+    head = advance(h, bytes);
+    if (depth + bytes > max_depth) {
+      max_depth = depth + bytes;
+    }
+    return true;
+  }
+
+  /**
+   * @brief Write the full sectors in the queue, call it from the consumer
+   * @param max_sectors maximum number of sectors to write in one call,
+   * consecutive sectors are written together.
+   * @return the number of sectors written, or -1 if the device failed.
+   */
+  int32_t update(uint32_t max_sectors = 0xFFFFFFFF) {
+    if (error) {
+      return -1;
+    }
+    int32_t count = 0;
+    uint32_t available = distance(tail, head) / SECTOR_SIZE;
+    while (available && max_sectors) {
+      uint32_t pos = tail % queue_size;
+      uint32_t n = (queue_size - pos) / SECTOR_SIZE; // up to the end of the queue
+      if (n > available) {
+        n = available;
+      }
+      if (n > max_sectors) {
+        n = max_sectors;
+      }
+      if (!writeQueue(pos, n)) {
+        return -1;
+      }
+      available -= n;
+      max_sectors -= n;
+      count += n;
+    }
+    return count;
+  }
+
+  /**
+   * @brief Write everything in the queue, the last sector is padded with
+   * zeros. Call it when the producer is done.
+   * The padding isn't counted in bytesLogged, truncate the file to it.
+   * @return false if the device failed, the rest stays queued.
+   */
+  bool flush() {
+    if (update() < 0) {
+      return false;
+    }
+    uint32_t rest = distance(tail, head);
+    if (rest == 0) {
+      return true;
+    }
+    // the sector is always whole in the queue, tail is at a sector boundary
+    uint32_t pos = tail % queue_size;
+    memset(queue + pos + rest, 0, SECTOR_SIZE - rest);
+    if (!device.writeSectors(first + written, queue + pos, 1)) {
+      error = true;
+      return false;
+    }
+    padding = SECTOR_SIZE - rest;
+    written = written + 1;
+    head = advance(head, padding);
+    tail = head;
+    return true;
+  }
+
+  //! Samples dropped because the queue (or the file) was full
+  uint32_t droppedSamples() { return dropped; }
+  //! Bytes waiting in the queue
+  uint32_t queueDepth() { return distance(tail, head); }
+  //! Worst case queue depth seen since begin, in bytes
+  uint32_t maxQueueDepth() { return max_depth; }
+  //! Size of the queue in bytes
+  uint32_t queueSize() { return queue_size; }
+  //! Sectors written since begin
+  uint32_t sectorsWritten() { return written; }
+  //! Bytes logged (written or queued) since begin, without the padding of flush
+  uint64_t bytesLogged() { return (uint64_t)written * SECTOR_SIZE - padding + queueDepth(); }
+  //! The device failed, nothing else is written
+  bool failed() { return error; }
+
+private:
+  // head and tail go from 0 to 2 * queue_size, so a full queue isn't empty
+  uint32_t advance(uint32_t index, uint32_t bytes) {
+    index += bytes;
+    return (index >= 2 * queue_size) ? index - 2 * queue_size : index;
+  }
+  uint32_t distance(uint32_t from, uint32_t to) {
+    return (to >= from) ? to - from : to + 2 * queue_size - from;
+  }
+
+  bool writeQueue(uint32_t pos, uint32_t n) {
+    if (!device.writeSectors(first + written, queue + pos, n)) {
+      error = true;
+      return false;
+    }
+    written = written + n;
+    __sync_synchronize(); // done with the queue before it's handed back
+    tail = advance(tail, n * SECTOR_SIZE);
+    return true;
+  }
+
+  BlockDevice &device;
+  uint8_t *queue;
+  uint32_t queue_size;
+  uint32_t first = 0;
+  uint32_t sectors = 0;
+  volatile uint32_t written = 0;
+  volatile uint32_t head = 0; // next byte pushed
+  volatile uint32_t tail = 0; // next byte written
+  volatile uint32_t max_depth = 0;
+  volatile uint32_t dropped = 0;
+  uint32_t padding = 0; // zeros flush added after the last sample
+  bool error = false;
+};
+
+#endif // ADC_LOGGER_H
@@ -0,0 +1,259 @@
+/* Teensy 4.x, 3.x, LC ADC library
+ * https://github.com/pedvide/ADC
+ * Copyright (c) 2020 Pedro Villanueva
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* PDB frequency solver and pretrigger sequences. Plain C++ so they can be
+ * tested on a computer, see extras/pdb_frequency.
+ */
+
+#ifndef ADC_PDB_H
+#define ADC_PDB_H
+
+#include <stdint.h>
+
+/**
+ * @brief Choose the PDB prescaler, multiplier and modulus for a frequency.
+ *
+ * The PDB counts at f_bus / (prescaler * mult) and restarts every mod counts,
+ * so the trigger frequency is f_bus / (prescaler * mult * mod), with the
+ * prescaler 1, 2, 4, ..., 128, the multiplier 1, 10, 20 or 40 and mod from 1
+ * to 65536.
+ */
+namespace ADC_pdb {
+
+//! Largest modulus, the MOD register is mod - 1
+constexpr uint32_t max_mod = 0x10000;
+
+//! A PDB configuration
+struct Setting {
+  uint8_t prescaler; /**< PRESCALER field, the counter is divided by 2^prescaler. */
+  uint8_t mult;      /**< MULT field, the counter is divided by 1, 10, 20 or 40. */
+  uint32_t mod;      /**< Counts per period, from 1 to max_mod. */
+};
+
+//! Clock divider of the prescaler and mult fields
+constexpr uint32_t divider(uint8_t prescaler, uint8_t mult) {
+  return (1u << prescaler) * ((mult == 0) ? 1u : (10u << (mult - 1)));
+}
+
+//! Frequency of the setting
+inline double frequency(uint32_t f_bus, const Setting &setting) {
+  return (double)f_bus /
+         ((double)divider(setting.prescaler, setting.mult) * setting.mod);
+}
+
+/**
+ * @brief Find the setting closest to the frequency.
+ * It tries all the prescaler and mult combinations with the two moduli
+ * around the exact one and keeps the one with the smallest error, the one
+ * with the smallest divider if there's a tie (the finest delay steps).
+ * @param f_bus PDB clock.
+ * @param freq frequency in Hz.
+ * @param setting the best setting, if any.
+ * @return false if the frequency is 0 or higher than f_bus.
+ */
+inline bool solve(uint32_t f_bus, uint32_t freq, Setting *setting) {
+  if ((freq == 0) || (freq > f_bus)) {
+    return false;
+  }
+  double best_error = -1;
+  uint64_t best_div = 0;
+  for (uint8_t prescaler = 0; prescaler < 8; prescaler++) {
+    for (uint8_t mult = 0; mult < 4; mult++) {
+      const uint64_t div = divider(prescaler, mult);
+      // the two moduli around f_bus / (div * freq)
+      uint64_t mod = f_bus / (div * freq);
+      for (uint8_t i = 0; i < 2; i++, mod++) {
+        if ((mod == 0) || (mod > max_mod)) {
+          continue;
+        }
+        const double achieved = (double)f_bus / (double)(div * mod);
+        const double error =
+            (achieved > freq) ? achieved - freq : freq - achieved;
+        if ((best_error < 0) || (error < best_error) ||
+            ((error == best_error) && (div < best_div))) {
+          best_error = error;
+          best_div = div;
+          setting->prescaler = prescaler;
+          setting->mult = mult;
+          setting->mod = (uint32_t)mod;
+        }
+      }
+    }
+  }
+  return best_error >= 0;
+}
+
+//! Most conversions of a Sequence, two pretriggers per ADC
+constexpr uint8_t max_steps = 4;
+
+//! A conversion of a Sequence
+struct Step {
+  uint8_t adc_num;    /**< ADC, 0 or 1. */
+  uint8_t pretrigger; /**< 0 converts SC1A (result in RA), 1 SC1B (in RB). */
+  uint8_t pin;        /**< Pin to convert. */
+  uint32_t delay_ns;  /**< Delay from the start of the period. */
+  bool back_to_back;  /**< Start when the previous pretrigger is done. */
+};
+
+//! PDB channel registers of a Sequence
+struct SequenceRegisters {
+  uint32_t c1[2];     /**< CH0C1 and CH1C1. */
+  uint16_t dly[2][2]; /**< CHnDLY0 and CHnDLY1 of each channel. */
+};
+
+/**
+ * @brief Conversions of both ADCs at fixed delays in each PDB period.
+ *
+ * Each ADC has two pretriggers, 0 converts the pin of SC1A and 1 the pin of
+ * SC1B, so up to four pins are converted each period without the CPU. A
+ * pretrigger starts its conversion delay_ns after the start of the period,
+ * or back to back, as soon as the conversion of the previous pretrigger in
+ * the ring ADC0 0, ADC0 1, ADC1 0, ADC1 1 (and back to ADC0 0) is done. The
+ * two conversions of an ADC must not overlap: leave at least a conversion
+ * time between their delays, or make the second one back to back.
+ */
+class Sequence {
+public:
+  //! Add a conversion delay_ns after the start of the period
+  /** \return the index of the step, or -1 if the pretrigger is already used
+   * or there's no space.
+   */
+  int8_t add(uint8_t adc_num, uint8_t pretrigger, uint8_t pin,
+             uint32_t delay_ns) {
+    return addStep(adc_num, pretrigger, pin, delay_ns, false);
+  }
+
+  //! Add a conversion that starts when the previous one in the ring is done
+  int8_t addBackToBack(uint8_t adc_num, uint8_t pretrigger, uint8_t pin) {
+    return addStep(adc_num, pretrigger, pin, 0, true);
+  }
+
+  //! Remove all the steps
+  void clear() { step_num = 0; }
+
+  //! Number of steps
+  uint8_t stepNum() const { return step_num; }
+  //! A step
+  const Step &step(uint8_t index) const { return steps[index]; }
+  //! The step of the pretrigger, or nullptr
+  const Step *find(uint8_t adc_num, uint8_t pretrigger) const {
+    for (uint8_t i = 0; i < step_num; i++) {
+      if ((steps[i].adc_num == adc_num) &&
+          (steps[i].pretrigger == pretrigger)) {
+        return &steps[i];
+      }
+    }
+    return nullptr;
+  }
+
+  //! Delay of a step in PDB counts, rounded
+  static uint32_t delayTicks(uint32_t f_bus, const Setting &setting,
+                             uint32_t delay_ns) {
+    const uint64_t div =
+        (uint64_t)divider(setting.prescaler, setting.mult) * 1000000000u;
+    return (uint32_t)(((uint64_t)delay_ns * f_bus + div / 2) / div);
+  }
+
+  //! Delay of a step that you get, in ns
+  double delayNs(uint32_t f_bus, const Setting &setting,
+                 uint8_t index) const {
+    return 1e9 * delayTicks(f_bus, setting, steps[index].delay_ns) *
+           divider(setting.prescaler, setting.mult) / f_bus;
+  }
+
+  /**
+   * @brief Registers of the PDB channels for the sequence.
+   * @param f_bus PDB clock.
+   * @param setting period of the PDB.
+   * @param adc_count number of ADCs of the board.
+   * @param regs the CHnC1 and CHnDLYm values.
+   * @return false if a delay isn't shorter than the period, a step uses an
+   * ADC that the board doesn't have, the pretrigger before a back to back one
+   * isn't in the sequence, or all of them are back to back.
+   */
+  bool compile(uint32_t f_bus, const Setting &setting, uint8_t adc_count,
+               SequenceRegisters *regs) const {
+    bool started = false;
+    *regs = {};
+    for (uint8_t i = 0; i < step_num; i++) {
+      const Step &s = steps[i];
+      if (s.adc_num >= adc_count) {
+        return false;
+      }
+      const uint32_t en = 1u << s.pretrigger;
+      if (s.back_to_back) {
+        uint8_t adc_num, pretrigger;
+        if (!previous(s, adc_count, &adc_num, &pretrigger) ||
+            !find(adc_num, pretrigger)) {
+          return false;
+        }
+        regs->c1[s.adc_num] |= (en << 16) | en; // BB and EN
+      } else {
+        const uint32_t ticks = delayTicks(f_bus, setting, s.delay_ns);
+        if (ticks >= setting.mod) {
+          return false;
+        }
+        regs->dly[s.adc_num][s.pretrigger] = (uint16_t)ticks;
+        regs->c1[s.adc_num] |= (en << 8) | en; // TOS and EN
+        started = true;
+      }
+    }
+    return started;
+  }
+
+private:
+  int8_t addStep(uint8_t adc_num, uint8_t pretrigger, uint8_t pin,
+                 uint32_t delay_ns, bool back_to_back) {
+    if ((step_num >= max_steps) || (adc_num > 1) || (pretrigger > 1) ||
+        find(adc_num, pretrigger)) {
+      return -1;
+    }
+    steps[step_num] = {adc_num, pretrigger, pin, delay_ns, back_to_back};
+    return step_num++;
+  }
+
+  // Pretrigger whose conversion starts a back to back one
+  static bool previous(const Step &s, uint8_t adc_count, uint8_t *adc_num,
+                       uint8_t *pretrigger) {
+    if (s.pretrigger == 1) {
+      *adc_num = s.adc_num;
+      *pretrigger = 0;
+      return true;
+    }
+    if (adc_count < 2) {
+      return false; // the ring needs both ADCs
+    }
+    *adc_num = 1 - s.adc_num;
+    *pretrigger = 1;
+    return true;
+  }
+
+  Step steps[max_steps];
+  uint8_t step_num = 0;
+};
+
+} // namespace ADC_pdb
+
+#endif // ADC_PDB_H
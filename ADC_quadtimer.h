@@ -0,0 +1,134 @@
+/* Teensy 4.x, 3.x, LC ADC library
+ * https://github.com/pedvide/ADC
+ * Copyright (c) 2020 Pedro Villanueva
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* QuadTimer frequency solver of the Teensy 4. Plain C++ so it can be tested
+ * on a computer.
+ */
+
+#ifndef ADC_QUADTIMER_H
+#define ADC_QUADTIMER_H
+
+#include <stdint.h>
+
+/**
+ * @brief Choose the QuadTimer prescaler and periods for a frequency.
+ *
+ * A channel counts the IP bus clock divided by 2^prescaler and its output
+ * pulses once every period counts. For lower frequencies a second (cascade)
+ * channel does that and the first one counts its pulses instead, so the
+ * frequency is f_clock / (2^prescaler * period * cascade_period).
+ */
+namespace ADC_quadtimer {
+
+//! Shortest period, the output needs a high and a low count
+constexpr uint32_t min_period = 3;
+//! Longest period of a channel, LOAD and CMPLD1 are 16 bits
+constexpr uint32_t max_period = 65534;
+//! Cascade periods tried for each prescaler
+constexpr uint32_t cascade_tries = 1024;
+
+//! A QuadTimer configuration
+struct Setting {
+  uint8_t prescaler;       /**< PCS - 8, the clock is divided by 2^prescaler. */
+  uint32_t period;         /**< Counts of the output channel per period. */
+  uint32_t cascade_period; /**< Clock counts of the cascade channel per count
+                              of the output channel, 0 if not cascaded. */
+};
+
+//! Clock counts per period of the setting
+constexpr uint64_t ticks(const Setting &setting) {
+  return ((uint64_t)setting.period << setting.prescaler) *
+         (setting.cascade_period ? setting.cascade_period : 1);
+}
+
+//! Frequency of the setting
+inline double frequency(uint32_t f_clock, const Setting &setting) {
+  return (double)f_clock / (double)ticks(setting);
+}
+
+/**
+ * @brief Find the setting closest to the frequency.
+ * Without cascade it tries the two periods around the exact one for each
+ * prescaler. Frequencies too low for a single channel are cascaded, the
+ * output channel period goes from the smallest that fits up to
+ * cascade_tries more, with the closest cascade period for each.
+ * @param f_clock IP bus clock (F_BUS_ACTUAL).
+ * @param freq frequency in Hz.
+ * @param setting the best setting, if any.
+ * @return false if the frequency is out of range.
+ */
+inline bool solve(uint32_t f_clock, double freq, Setting *setting) {
+  if (!(freq > 0) || (freq > (double)f_clock / min_period)) {
+    return false;
+  }
+  const double exact = (double)f_clock / freq; // clock counts per period
+  double best_error = -1;
+  auto consider = [&](uint8_t prescaler, uint64_t period, uint64_t cascade) {
+    if ((period < min_period) || (period > max_period) ||
+        (cascade && ((cascade < min_period) || (cascade > max_period)))) {
+      return;
+    }
+    Setting candidate = {prescaler, (uint32_t)period, (uint32_t)cascade};
+    const double achieved = frequency(f_clock, candidate);
+    const double error = (achieved > freq) ? achieved - freq : freq - achieved;
+    if ((best_error < 0) || (error < best_error)) {
+      best_error = error;
+      *setting = candidate;
+    }
+  };
+
+  for (uint8_t prescaler = 0; prescaler < 8; prescaler++) {
+    const double counts = exact / (1u << prescaler);
+    if (counts > 2.0 * max_period) {
+      continue;
+    }
+    consider(prescaler, (uint64_t)counts, 0);
+    consider(prescaler, (uint64_t)counts + 1, 0);
+  }
+  if (best_error >= 0) {
+    return true;
+  }
+
+  // cascaded: counts = period * cascade_period
+  for (uint8_t prescaler = 0; prescaler < 8; prescaler++) {
+    const double counts = exact / (1u << prescaler);
+    if (counts > (double)max_period * max_period) {
+      continue;
+    }
+    uint64_t period = (uint64_t)(counts / max_period);
+    period = (period < min_period) ? min_period : period;
+    for (uint32_t i = 0; (i < cascade_tries) && (period <= max_period);
+         i++, period++) {
+      const uint64_t cascade = (uint64_t)(counts / period);
+      consider(prescaler, period, cascade);
+      consider(prescaler, period, cascade + 1);
+    }
+  }
+  return best_error >= 0;
+}
+
+} // namespace ADC_quadtimer
+
+#endif // ADC_QUADTIMER_H
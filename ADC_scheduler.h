@@ -0,0 +1,344 @@
+/* Teensy 4.x, 3.x, LC ADC library
+ * https://github.com/pedvide/ADC
+ * Copyright (c) 2020 Pedro Villanueva
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @page scheduler ADC scheduler
+ * Samples several channels, each at its own rate, with one ADC and one
+ * timer. The plan is a repeating table of pins, one conversion per timer
+ * tick, for AnalogBufferDMA::scanMode. The samples of the DMA buffers are
+ * sorted into a ring buffer per channel.
+ * It's plain C++, so the plans can be checked on a computer, see
+ * extras/adc_scheduler.
+ */
+
+#ifndef ADC_SCHEDULER_H
+#define ADC_SCHEDULER_H
+
+#include <stdint.h>
+
+//! Maximum number of channels of a scheduler
+#ifndef ADC_SCHEDULER_MAX_CHANNELS
+#define ADC_SCHEDULER_MAX_CHANNELS 8
+#endif
+
+//! Maximum length of the table of pins, at most ADC_DMA_MAX_SCAN_PINS
+#ifndef ADC_SCHEDULER_MAX_SLOTS
+#define ADC_SCHEDULER_MAX_SLOTS 32
+#endif
+
+/**
+ * @brief Plan of conversions for channels at different rates.
+ *
+ * The timer ticks at a multiple of all the rates and each channel is
+ * converted every divider = timer / rate ticks. The fast channels get
+ * evenly spaced slots of the table, whose length is the least common
+ * multiple of their dividers. A slow channel (divider longer than the table)
+ * gets a single slot, and only one out of every divider / table length
+ * conversions in it is kept. The remaining slots convert the first channel
+ * and are dropped.
+ *
+ * Usage with AnalogBufferDMA (Teensy 3.x, with the PDB):
+ *   - addChannel for each pin and rate, then build.
+ *   - abdma.scanMode(slotPins(), slotNum()) with buffer sizes that are
+ *     multiples of slotNum().
+ *   - startSingleRead(slotPins()[0]) and startTimer(timerFrequency()).
+ *   - demux each buffer with its bufferFirstSampleAcquired() and read the
+ *     samples of each channel.
+ */
+class ADC_Scheduler {
+public:
+  //! Slot that doesn't belong to any channel
+  static const uint8_t IDLE = 0xFF;
+
+  /**
+   * @brief Add a channel.
+   * @param pin pin to convert.
+   * @param rate samples per second.
+   * @param buffer ring buffer for the samples of the channel.
+   * @param size size of the buffer.
+   * @return the channel index, or -1 if there's no space or rate is 0.
+   */
+  int8_t addChannel(uint8_t pin, uint32_t rate, uint16_t *buffer,
+                    uint16_t size) {
+    if ((channel_num >= ADC_SCHEDULER_MAX_CHANNELS) || (rate == 0) ||
+        !buffer || (size == 0)) {
+      return -1;
+    }
+    Channel &channel = channels[channel_num];
+    channel.pin = pin;
+    channel.rate = rate;
+    channel.buffer = buffer;
+    channel.size = size;
+    channel.head = channel.tail = 0;
+    channel.dropped = 0;
+    built = false;
+    return channel_num++;
+  }
+
+  /**
+   * @brief Find a plan for the channels.
+   * It tries the timer frequencies that are multiples of all the rates, from
+   * the lowest, until all the fast channels fit in the table without sharing
+   * any slot.
+   * @param max_rate highest timer frequency (conversions per second).
+   * @param max_slots longest table.
+   * @return false if there's no plan.
+   */
+  bool build(uint32_t max_rate, uint8_t max_slots = ADC_SCHEDULER_MAX_SLOTS) {
+    built = false;
+    if ((channel_num == 0) || (max_slots == 0) ||
+        (max_slots > ADC_SCHEDULER_MAX_SLOTS)) {
+      return false;
+    }
+    uint64_t rates_lcm = 1;
+    for (uint8_t c = 0; c < channel_num; c++) {
+      rates_lcm = lcm(rates_lcm, channels[c].rate);
+      if (rates_lcm > max_rate) {
+        return false;
+      }
+    }
+    for (uint64_t freq = rates_lcm; freq <= max_rate; freq += rates_lcm) {
+      if (assign((uint32_t)freq, max_slots)) {
+        timer_frequency = (uint32_t)freq;
+        built = true;
+        resetDemux();
+        return true;
+      }
+    }
+    return false;
+  }
+
+  //! Was build successful?
+  bool isBuilt() const { return built; }
+  //! Timer frequency of the plan
+  uint32_t timerFrequency() const { return timer_frequency; }
+  //! Length of the table
+  uint8_t slotNum() const { return slot_num; }
+  //! Table of pins, one per timer tick
+  const uint8_t *slotPins() const { return slot_pins; }
+  //! Channel of a slot, or IDLE
+  uint8_t slotChannel(uint8_t slot) const { return slot_channels[slot]; }
+  //! Number of channels
+  uint8_t channelNum() const { return channel_num; }
+  //! Timer ticks between samples of the channel
+  uint32_t channelDivider(uint8_t channel) const {
+    return channels[channel].divider;
+  }
+  //! Timer tick of the first sample of the channel
+  uint32_t channelOffset(uint8_t channel) const {
+    return channels[channel].offset;
+  }
+
+  //! Start the demultiplexing again from timer tick 0
+  void resetDemux() {
+    next_tick = 0;
+    for (uint8_t c = 0; c < channel_num; c++) {
+      channels[c].head = channels[c].tail = 0;
+      channels[c].dropped = 0;
+    }
+  }
+
+  /**
+   * @brief Sort the conversions of a buffer into the channels.
+   * @param buffer conversions in timer tick order.
+   * @param count number of conversions.
+   * @param first_tick timer tick of the first conversion (the index of the
+   * sample since init of AnalogBufferDMA), so dropped buffers don't shift
+   * the channels.
+   */
+  void demux(const volatile uint16_t *buffer, uint16_t count,
+             uint64_t first_tick) {
+    if (!built) {
+      return;
+    }
+    uint8_t slot = first_tick % slot_num;
+    uint64_t frame = first_tick / slot_num;
+    for (uint16_t i = 0; i < count; i++) {
+      const uint8_t c = slot_channels[slot];
+      if (c != IDLE) {
+        Channel &channel = channels[c];
+        if ((channel.frames_per_sample == 1) ||
+            (frame % channel.frames_per_sample == 0)) {
+          push(channel, buffer[i]);
+        }
+      }
+      if (++slot == slot_num) {
+        slot = 0;
+        frame++;
+      }
+    }
+    next_tick = first_tick + count;
+  }
+
+  //! Sort the conversions of a buffer that follows the previous one
+  void demux(const volatile uint16_t *buffer, uint16_t count) {
+    demux(buffer, count, next_tick);
+  }
+
+  //! Samples of the channel ready to read
+  uint16_t available(uint8_t channel) const {
+    const Channel &ch = channels[channel];
+    return (uint16_t)(ch.head - ch.tail);
+  }
+
+  //! Copy up to max samples of the channel, returns how many
+  uint16_t read(uint8_t channel, uint16_t *dest, uint16_t max) {
+    Channel &ch = channels[channel];
+    uint16_t n = 0;
+    uint32_t tail = ch.tail;
+    while ((n < max) && (tail != ch.head)) {
+      dest[n++] = ch.buffer[tail % ch.size];
+      tail++;
+    }
+    ch.tail = tail;
+    return n;
+  }
+
+  //! Samples of the channel lost because its buffer was full
+  uint32_t droppedSamples(uint8_t channel) const {
+    return channels[channel].dropped;
+  }
+
+private:
+  struct Channel {
+    uint8_t pin;
+    uint32_t rate;
+    uint32_t divider;
+    uint32_t offset;
+    uint32_t frames_per_sample; // 1 for the fast channels
+    uint16_t *buffer;
+    uint16_t size;
+    volatile uint32_t head; // written by demux
+    volatile uint32_t tail; // written by read
+    uint32_t dropped;
+  };
+
+  static uint64_t gcd(uint64_t a, uint64_t b) {
+    while (b) {
+      const uint64_t t = a % b;
+      a = b;
+      b = t;
+    }
+    return a;
+  }
+  static uint64_t lcm(uint64_t a, uint64_t b) { return a / gcd(a, b) * b; }
+
+  void push(Channel &channel, uint16_t value) {
+    if (channel.head - channel.tail >= channel.size) {
+      channel.dropped++;
+      return;
+    }
+    channel.buffer[channel.head % channel.size] = value;
+    channel.head = channel.head + 1;
+  }
+
+  // Place the channels in a table for the timer frequency
+  bool assign(uint32_t freq, uint8_t max_slots) {
+    // fastest first
+    uint8_t order[ADC_SCHEDULER_MAX_CHANNELS];
+    for (uint8_t c = 0; c < channel_num; c++) {
+      channels[c].divider = freq / channels[c].rate;
+      uint8_t i = c;
+      while ((i > 0) && (channels[order[i - 1]].divider > channels[c].divider)) {
+        order[i] = order[i - 1];
+        i--;
+      }
+      order[i] = c;
+    }
+
+    // the table is as long as the fast dividers need
+    uint64_t length = 1;
+    uint8_t fast_num = 0;
+    for (; fast_num < channel_num; fast_num++) {
+      const uint64_t new_length =
+          lcm(length, channels[order[fast_num]].divider);
+      if (new_length > max_slots) {
+        break;
+      }
+      length = new_length;
+    }
+    slot_num = (uint8_t)length;
+    for (uint8_t s = 0; s < slot_num; s++) {
+      slot_channels[s] = IDLE;
+    }
+
+    for (uint8_t i = 0; i < channel_num; i++) {
+      Channel &channel = channels[order[i]];
+      if (i < fast_num) {
+        // first offset whose slots are all free
+        uint32_t offset = 0;
+        for (; offset < channel.divider; offset++) {
+          bool free = true;
+          for (uint32_t s = offset; free && (s < slot_num); s += channel.divider) {
+            free = (slot_channels[s] == IDLE);
+          }
+          if (free) {
+            break;
+          }
+        }
+        if (offset == channel.divider) {
+          return false;
+        }
+        for (uint32_t s = offset; s < slot_num; s += channel.divider) {
+          slot_channels[s] = order[i];
+        }
+        channel.offset = offset;
+        channel.frames_per_sample = 1;
+      } else {
+        // a free slot, once every frames_per_sample tables
+        if (channel.divider % slot_num) {
+          return false;
+        }
+        uint8_t s = 0;
+        while ((s < slot_num) && (slot_channels[s] != IDLE)) {
+          s++;
+        }
+        if (s == slot_num) {
+          return false;
+        }
+        slot_channels[s] = order[i];
+        channel.offset = s;
+        channel.frames_per_sample = channel.divider / slot_num;
+      }
+    }
+
+    for (uint8_t s = 0; s < slot_num; s++) {
+      const uint8_t c = slot_channels[s];
+      slot_pins[s] = channels[(c == IDLE) ? 0 : c].pin;
+    }
+    return true;
+  }
+
+  Channel channels[ADC_SCHEDULER_MAX_CHANNELS];
+  uint8_t channel_num = 0;
+  uint8_t slot_pins[ADC_SCHEDULER_MAX_SLOTS];
+  uint8_t slot_channels[ADC_SCHEDULER_MAX_SLOTS];
+  uint8_t slot_num = 0;
+  uint32_t timer_frequency = 0;
+  uint64_t next_tick = 0;
+  bool built = false;
+};
+
+#endif // ADC_SCHEDULER_H
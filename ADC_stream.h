@@ -0,0 +1,90 @@
+/* Teensy 4.x, 3.x, LC ADC library
+ * https://github.com/pedvide/ADC
+ * Copyright (c) 2020 Pedro Villanueva
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @page stream ADC stream frames
+ * Binary frame format used by AnalogBufferDMAStream to send DMA buffers.
+ * It only depends on stdint.h, so host programs can include it to decode
+ * the stream, see extras/adc_stream.
+ */
+
+#ifndef ADC_STREAM_H
+#define ADC_STREAM_H
+
+#include <stdint.h>
+
+//! First bytes of every frame, "ADCS"
+#define ADC_STREAM_MAGIC 0x53434441
+//! Version of the frame format, 2 added header_crc
+#define ADC_STREAM_VERSION 2
+//! Largest header_size a decoder accepts, room for fields of newer versions
+#define ADC_STREAM_MAX_HEADER_SIZE 64
+
+//! The samples are signed (differential conversions)
+#define ADC_STREAM_FLAG_SIGNED 0x01
+//! Buffers were dropped (overrun) since the previous frame
+#define ADC_STREAM_FLAG_OVERRUN 0x02
+
+/**
+ * @brief Header of each frame, followed by count samples.
+ *
+ * All fields and samples are little endian (like the Teensy).
+ * Skip header_size bytes to get to the samples, newer versions may append
+ * fields to the header.
+ * Since version 2 header_crc lets a decoder tell a real header from the magic
+ * appearing in the samples, version 1 headers had 0 there.
+ */
+struct ADC_StreamHeader {
+  uint32_t magic;      /**< ADC_STREAM_MAGIC */
+  uint8_t version;     /**< ADC_STREAM_VERSION */
+  uint8_t channel;     /**< channel ID of the stream */
+  uint8_t flags;       /**< ADC_STREAM_FLAG_* */
+  uint8_t header_size; /**< size of the header in bytes */
+  uint32_t sequence;   /**< buffer number since init, a gap means dropped buffers */
+  uint16_t count;      /**< number of 16 bit samples after the header */
+  uint16_t interleave; /**< pins interleaved in the samples (scan or synchronized modes) */
+  uint64_t timestamp;  /**< completion of the buffer in timestamp_frequency ticks */
+  uint32_t timestamp_frequency; /**< ticks per second of the timestamps */
+  uint16_t header_crc; /**< adcStreamCRC16 of the header_size bytes with this field 0 */
+  uint16_t reserved;   /**< keeps the header 8 byte aligned */
+};
+
+static_assert(sizeof(ADC_StreamHeader) == 32, "ADC_StreamHeader must be packed");
+
+/**
+ * @brief CRC-16/CCITT (polynomial 0x1021, initial value 0xFFFF) of the bytes.
+ * @param crc previous result to continue a CRC, 0xFFFF to start a new one.
+ */
+inline uint16_t adcStreamCRC16(const uint8_t *data, uint16_t size, uint16_t crc = 0xFFFF) {
+  for (uint16_t i = 0; i < size; i++) {
+    crc ^= (uint16_t)(data[i] << 8);
+    for (uint8_t bit = 0; bit < 8; bit++) {
+      crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+    }
+  }
+  return crc;
+}
+
+#endif // ADC_STREAM_H
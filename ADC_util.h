@@ -144,6 +144,8 @@ const char *getStringADCError(ADC_ERROR fail_flag) {
       return (const char *)"Wrong ADC";
     case ADC_ERROR::SYNCH:
       return (const char *)"Synchronous";
+    case ADC_ERROR::DMA:
+      return (const char *)"DMA buffer";
     case ADC_ERROR::OTHER:
     case ADC_ERROR::CLEAR: // silence warnings
     default:
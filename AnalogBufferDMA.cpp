@@ -36,18 +36,149 @@ AnalogBufferDMA *AnalogBufferDMA::_activeObjectPerADC[2] = {nullptr, nullptr};
 #define DMAMUX_ADC_0 DMAMUX_SOURCE_ADC1
 #define SOURCE_ADC_1 ADC2_R0
 #define DMAMUX_ADC_1 DMAMUX_SOURCE_ADC2
+#define CHANNEL_ADC_0 ADC1_HC0
+#define CHANNEL_ADC_1 ADC2_HC0
 #elif defined(KINETISK)
 #define SOURCE_ADC_0 ADC0_RA
 #define DMAMUX_ADC_0 DMAMUX_SOURCE_ADC0
+#define CHANNEL_ADC_0 ADC0_SC1A
 #ifdef ADC_DUAL_ADCS
 #define SOURCE_ADC_1 ADC1_RA
 #define DMAMUX_ADC_1 DMAMUX_SOURCE_ADC1
+#define CHANNEL_ADC_1 ADC1_SC1A
 #endif
 #elif defined(KINETISL)
 #define SOURCE_ADC_0 ADC0_RA
 #define DMAMUX_ADC_0 DMAMUX_SOURCE_ADC0
 #endif
 
+//=============================================================================
+// Source register of the DMA requests for the given ADC
+//=============================================================================
+static volatile uint16_t &sourceADC(int8_t adc_num)
+{
+#ifdef ADC_DUAL_ADCS
+  return (volatile uint16_t &)((adc_num == 1) ? SOURCE_ADC_1 : SOURCE_ADC_0);
+#else
+  (void)adc_num;
+  return (volatile uint16_t &)(SOURCE_ADC_0);
+#endif
+}
+
+//=============================================================================
+// Timestamp counter: the DWT cycle counter, LC doesn't have one so use micros
+//=============================================================================
+static inline uint32_t timestampTicks()
+{
+#ifndef KINETISL
+  return ARM_DWT_CYCCNT;
+#else
+  return micros();
+#endif
+}
+
+//=============================================================================
+// DMA channel state used to hand an ADC over between objects
+//=============================================================================
+static inline bool channelRunning(DMAChannel &channel)
+{
+#ifndef KINETISL
+  return DMA_ERQ & (1 << channel.channel);
+#else
+  return channel.CFG->DCR & DMA_DCR_ERQ;
+#endif
+}
+
+static inline bool interruptPending(DMAChannel &channel)
+{
+#ifndef KINETISL
+  return DMA_INT & (1 << channel.channel);
+#else
+  return channel.CFG->DSR_BCR & DMA_DSR_BCR_DONE;
+#endif
+}
+
+// only one channel can be routed to each DMAMUX source
+static inline void releaseTrigger(DMAChannel &channel)
+{
+#if defined(__IMXRT1062__)
+  (&DMAMUX_CHCFG0)[channel.channel] = 0;
+#else
+  (&DMAMUX0_CHCFG0)[channel.channel] = 0;
+#endif
+}
+
+#ifndef KINETISL
+//=============================================================================
+// Channel selection register (SC1A or HC0) of the given ADC
+//=============================================================================
+static volatile uint32_t &channelADC(int8_t adc_num)
+{
+#ifdef ADC_DUAL_ADCS
+  return (volatile uint32_t &)((adc_num == 1) ? CHANNEL_ADC_1 : CHANNEL_ADC_0);
+#else
+  (void)adc_num;
+  return (volatile uint32_t &)(CHANNEL_ADC_0);
+#endif
+}
+#endif
+
+#ifdef ADC_DUAL_ADCS
+//=============================================================================
+// Write every other sample of the destination buffer, the total size
+// in bytes (and so DLASTSGA) doesn't change.
+//=============================================================================
+static void interleaveDestination(DMABaseClass &dma, uint16_t count)
+{
+  dma.TCD->DOFF = 4;
+  dma.transferCount(count / 2);
+}
+#endif
+
+#if defined(__IMXRT1062__)
+//=============================================================================
+// Read the results of an ADC_ETC chain each request: one minor loop reads the
+// 16 bit halves of the RESULT registers and goes back to the first one.
+//=============================================================================
+static void chainSource(DMABaseClass &dma, int8_t adc_num, uint8_t chain_num, uint16_t count)
+{
+  dma.TCD->SADDR = &IMXRT_ADC_ETC.TRIG[(adc_num == 1) ? 4 : 0].RESULT_1_0;
+  dma.TCD->SOFF = 2;
+  dma.TCD->NBYTES = DMA_TCD_NBYTES_SMLOE | DMA_TCD_NBYTES_MLOFFYES_MLOFF(-2 * chain_num) |
+                    DMA_TCD_NBYTES_MLOFFYES_NBYTES(2 * chain_num);
+  dma.TCD->SLAST = 0;
+  dma.transferCount(count / chain_num);
+}
+#endif
+
+#ifdef KINETISK
+//=============================================================================
+// Read RA and RB in turns: they are 4 bytes apart, so an 8 byte source
+// modulo brings the address back to RA after RB.
+//=============================================================================
+static void pingPongSource(DMABaseClass &dma)
+{
+  dma.TCD->SOFF = 4;
+  dma.TCD->ATTR = (dma.TCD->ATTR & ~DMA_TCD_ATTR_SMOD(31)) | DMA_TCD_ATTR_SMOD(3);
+}
+#endif
+
+#if defined(__IMXRT1062__)
+//=============================================================================
+// Cached buffers (not in DTCM) are invalidated when the DMA fills them,
+// so they can't share a cache line with other data.
+//=============================================================================
+static inline bool bufferCached(volatile uint16_t *buffer)
+{
+  return (uint32_t)buffer >= 0x20200000u;
+}
+
+static inline bool bufferCacheAligned(volatile uint16_t *buffer, uint16_t count)
+{
+  return !bufferCached(buffer) || ((((uint32_t)buffer | (count * 2)) & 31) == 0);
+}
+#endif
+
 //=============================================================================
 // Debug support
 //=============================================================================
@@ -70,10 +201,54 @@ static void dumpDMA_TCD(DMABaseClass *dmabc)
 }
 #endif
 
+//=============================================================================
+// Constructors: one or two buffers, or a ring of buffer_num buffers
+//=============================================================================
+AnalogBufferDMA::AnalogBufferDMA(volatile uint16_t *buffer1, uint16_t buffer1_count,
+                                 volatile uint16_t *buffer2, uint16_t buffer2_count)
+{
+  _buffers[0] = buffer1;
+  _buffer_counts[0] = buffer1_count;
+  _buffer_num = 1;
+  if (buffer2 && buffer2_count)
+  {
+    _buffers[1] = buffer2;
+    _buffer_counts[1] = buffer2_count;
+    _buffer_num = 2;
+  }
+}
+
+AnalogBufferDMA::AnalogBufferDMA(volatile uint16_t *const *buffers, uint8_t buffer_num, uint16_t buffer_count)
+{
+  if (buffer_num > ADC_DMA_MAX_BUFFERS)
+    buffer_num = ADC_DMA_MAX_BUFFERS;
+  if (buffer_num == 0)
+    buffer_num = 1;
+  for (uint8_t i = 0; i < buffer_num; i++)
+  {
+    _buffers[i] = buffers[i];
+    _buffer_counts[i] = buffer_count;
+  }
+  _buffer_num = buffer_num;
+}
+
+AnalogBufferDMA::AnalogBufferDMA(volatile int16_t *buffer1, uint16_t buffer1_count,
+                                 volatile int16_t *buffer2, uint16_t buffer2_count)
+    : AnalogBufferDMA((volatile uint16_t *)buffer1, buffer1_count, (volatile uint16_t *)buffer2, buffer2_count)
+{
+  _signed = true;
+}
+
+AnalogBufferDMA::AnalogBufferDMA(volatile int16_t *const *buffers, uint8_t buffer_num, uint16_t buffer_count)
+    : AnalogBufferDMA((volatile uint16_t *const *)buffers, buffer_num, buffer_count)
+{
+  _signed = true;
+}
+
 //=============================================================================
 // Init - Initialize the object including setup DMA structures
 //=============================================================================
-void AnalogBufferDMA::init(ADC *adc, int8_t adc_num)
+bool AnalogBufferDMA::init(ADC *adc, int8_t adc_num)
 {
   // enable DMA and interrupts
 #ifdef DEBUG_DUMP_DATA
@@ -81,26 +256,76 @@ void AnalogBufferDMA::init(ADC *adc, int8_t adc_num)
   Serial.flush();
 #endif
 
-#ifndef KINETISL
-  // setup a DMA Channel.
-  // Now lets see the different things that RingbufferDMA setup for us before
-  // See if we were created with one or two buffers.  If one assume we stop on completion, else assume continuous.
-  if (_buffer2 && _buffer2_count)
+#if defined(__IMXRT1062__)
+  for (uint8_t i = 0; i < _buffer_num; i++)
   {
-#ifdef ADC_DUAL_ADCS
-    _dmasettings_adc[0].source((volatile uint16_t &)((adc_num == 1) ? SOURCE_ADC_1 : SOURCE_ADC_0));
-#else
-    _dmasettings_adc[0].source((volatile uint16_t &)(SOURCE_ADC_0));
+    if (!bufferCacheAligned(_buffers[i], _buffer_counts[i]))
+    {
+      adc->adc[adc_num]->fail_flag |= ADC_ERROR::DMA;
+      return false;
+    }
+  }
+  // write back and drop any cached data before the DMA starts writing
+  for (uint8_t i = 0; i < _buffer_num; i++)
+  {
+    if (bufferCached(_buffers[i]))
+      arm_dcache_flush_delete((void *)_buffers[i], _buffer_counts[i] * 2);
+  }
 #endif
-    _dmasettings_adc[0].destinationBuffer((uint16_t *)_buffer1, _buffer1_count * 2); // 2*b_size is necessary for some reason
-    _dmasettings_adc[0].replaceSettingsOnCompletion(_dmasettings_adc[1]);            // go off and use second one...
-    _dmasettings_adc[0].interruptAtCompletion();                                     //interruptAtHalf or interruptAtCompletion
+
+  _adc = adc;
 #ifdef ADC_DUAL_ADCS
-    _dmasettings_adc[1].source((volatile uint16_t &)((adc_num == 1) ? SOURCE_ADC_1 : SOURCE_ADC_0));
-    _dmasettings_adc[1].destinationBuffer((uint16_t *)_buffer2, _buffer2_count * 2); // 2*b_size is necessary for some reason
-    _dmasettings_adc[1].replaceSettingsOnCompletion(_dmasettings_adc[0]);            // Cycle back to the first one
-    _dmasettings_adc[1].interruptAtCompletion();                                     //interruptAtHalf or interruptAtCompletion
+  _adc_num = (adc_num == 1) ? 1 : 0;
+#endif
+
+#ifndef KINETISL
+#ifdef KINETISK
+  // the (RA, RB) pairs can't be split between buffers
+  for (uint8_t i = 0; _ping_pong && (i < _buffer_num); i++)
+  {
+    if (_buffer_counts[i] & 1)
+    {
+      adc->adc[adc_num]->fail_flag |= ADC_ERROR::DMA;
+      return false;
+    }
+  }
+#endif
+#if defined(__IMXRT1062__)
+  // neither the chains
+  for (uint8_t i = 0; _chain_num && (i < _buffer_num); i++)
+  {
+    if (_buffer_counts[i] % _chain_num)
+    {
+      adc->adc[adc_num]->fail_flag |= ADC_ERROR::DMA;
+      return false;
+    }
+  }
 #endif
+  if (_scan_num && !initScan(adc, adc_num))
+    return false;
+
+  // setup a DMA Channel.
+  // Now lets see the different things that RingbufferDMA setup for us before
+  // See if we were created with one or more buffers.  If one assume we stop on completion, else assume continuous.
+  if (_half_complete)
+  {
+    // One circular buffer, interrupt when each half is done
+    _dmachannel_adc.source(sourceADC(adc_num));
+    _dmachannel_adc.destinationBuffer((uint16_t *)_buffers[0], (_buffer_counts[0] + _buffer_counts[1]) * 2); // size in bytes
+    _dmachannel_adc.interruptAtHalf();
+    _dmachannel_adc.interruptAtCompletion();
+    _stop_on_completion = false;
+  }
+  else if (_buffer_num > 1)
+  {
+    // chain the buffers in a ring, each setting loads the next one when it's done
+    for (uint8_t i = 0; i < _buffer_num; i++)
+    {
+      _dmasettings_adc[i].source(sourceADC(adc_num));
+      _dmasettings_adc[i].destinationBuffer((uint16_t *)_buffers[i], _buffer_counts[i] * 2);         // size in bytes
+      _dmasettings_adc[i].replaceSettingsOnCompletion(_dmasettings_adc[(i + 1) % _buffer_num]); // go off and use next one...
+      _dmasettings_adc[i].interruptAtCompletion();                                                 //interruptAtHalf or interruptAtCompletion
+    }
 
     _dmachannel_adc = _dmasettings_adc[0];
 
@@ -110,35 +335,76 @@ void AnalogBufferDMA::init(ADC *adc, int8_t adc_num)
   {
 // Only one buffer so lets just setup the dmachannel ...
 // Serial.printf("AnalogBufferDMA::init Single buffer %d\n", adc_num);
-#ifdef ADC_DUAL_ADCS
-    _dmachannel_adc.source((volatile uint16_t &)((adc_num == 1) ? SOURCE_ADC_1 : SOURCE_ADC_0));
-#else
-    _dmachannel_adc.source((volatile uint16_t &)(SOURCE_ADC_0));
-#endif
-    _dmachannel_adc.destinationBuffer((uint16_t *)_buffer1, _buffer1_count * 2); // 2*b_size is necessary for some reason
+    _dmachannel_adc.source(sourceADC(adc_num));
+    _dmachannel_adc.destinationBuffer((uint16_t *)_buffers[0], _buffer_counts[0] * 2); // 2*b_size is necessary for some reason
     _dmachannel_adc.interruptAtCompletion();                                     //interruptAtHalf or interruptAtCompletion
     _dmachannel_adc.disableOnCompletion();                                       // we will disable on completion.
     _stop_on_completion = true;
   }
 
-  if (adc_num == 1)
+#ifdef KINETISK
+  if (_ping_pong)
   {
-#ifdef ADC_DUAL_ADCS
-    _activeObjectPerADC[1] = this;
-    _dmachannel_adc.attachInterrupt(&adc_1_dmaISR);
-    _dmachannel_adc.triggerAtHardwareEvent(DMAMUX_ADC_1); // start DMA channel when ADC finishes a conversion
+    if ((_buffer_num > 1) && !_half_complete)
+    {
+      for (uint8_t i = 0; i < _buffer_num; i++)
+        pingPongSource(_dmasettings_adc[i]);
+    }
+    pingPongSource(_dmachannel_adc);
+  }
 #endif
+#if defined(__IMXRT1062__)
+  if (_chain_num)
+  {
+    if ((_buffer_num > 1) && !_half_complete)
+    {
+      for (uint8_t i = 0; i < _buffer_num; i++)
+        chainSource(_dmasettings_adc[i], adc_num, _chain_num, _buffer_counts[i]);
+      _dmachannel_adc = _dmasettings_adc[0];
+    }
+    else
+    {
+      chainSource(_dmachannel_adc, adc_num, _chain_num, _half_complete ? _buffer_counts[0] + _buffer_counts[1] : _buffer_counts[0]);
+    }
   }
-  else
+#endif
+
+#ifdef ADC_DUAL_ADCS
+  if (_synchronized)
   {
-    _activeObjectPerADC[0] = this;
-    _dmachannel_adc.attachInterrupt(&adc_0_dmaISR);
-    _dmachannel_adc.triggerAtHardwareEvent(DMAMUX_ADC_0); // start DMA channel when ADC finishes a conversion
+    // leave room for the ADC1 results: half the transfers, every other sample
+    if ((_buffer_num > 1) && !_half_complete)
+    {
+      for (uint8_t i = 0; i < _buffer_num; i++)
+        interleaveDestination(_dmasettings_adc[i], _buffer_counts[i]);
+    }
+    interleaveDestination(_dmachannel_adc, _half_complete ? _buffer_counts[0] + _buffer_counts[1] : _buffer_counts[0]);
   }
-  //arm_dcache_flush((void*)dmaChannel, sizeof(dmaChannel));
-  _dmachannel_adc.enable();
+#endif
 
-  adc->adc[adc_num]->continuousMode();
+  if (_scan_num)
+  {
+    // each transfer of the buffers triggers the scan channel,
+    // the last one of each buffer only links at completion
+    if (!_half_complete)
+    {
+      for (uint8_t i = 0; i < _buffer_num; i++)
+      {
+        _dmachannel_scan->triggerAtTransfersOf(_dmasettings_adc[i]);
+        _dmachannel_scan->triggerAtCompletionOf(_dmasettings_adc[i]);
+      }
+    }
+    _dmachannel_scan->triggerAtTransfersOf(_dmachannel_adc);
+    _dmachannel_scan->triggerAtCompletionOf(_dmachannel_adc);
+    _dmachannel_scan->enable();
+  }
+
+  attachADC(adc_num);
+  if (!_preparing)
+  {
+    _dmachannel_adc.enable();
+    adc->adc[adc_num]->continuousMode();
+  }
   adc->adc[adc_num]->enableDMA();
 
 #ifdef DEBUG_DUMP_DATA
@@ -163,15 +429,28 @@ void AnalogBufferDMA::init(ADC *adc, int8_t adc_num)
   // Now lets see the different things that RingbufferDMA setup for us before
   _dmachannel_adc.source((volatile uint16_t &)(SOURCE_ADC_0));
   ;
-  _dmachannel_adc.destinationBuffer((uint16_t *)_buffer1, _buffer1_count * 2); // 2*b_size is necessary for some reason
-  _dmachannel_adc.disableOnCompletion();                                       // ISR will hae to restart with other buffer
+  if (_half_complete)
+  {
+    if (!initGapless())
+    {
+      adc->adc[adc_num]->fail_flag |= ADC_ERROR::DMA;
+      return false;
+    }
+  }
+  else
+  {
+    _dmachannel_adc.destinationBuffer((uint16_t *)_buffers[0], _buffer_counts[0] * 2); // 2*b_size is necessary for some reason
+    _dmachannel_adc.disableOnCompletion();                                       // ISR will hae to restart with other buffer
+  }
   _dmachannel_adc.interruptAtCompletion();                                     //interruptAtHalf or interruptAtCompletion
-  _activeObjectPerADC[0] = this;
   _dmachannel_adc.attachInterrupt(&adc_0_dmaISR);
-  _dmachannel_adc.triggerAtHardwareEvent(DMAMUX_ADC_0); // start DMA channel when ADC finishes a conversion
-  _dmachannel_adc.enable();
-
-  adc->startContinuous(adc_num);
+  if (!_preparing)
+  {
+    _activeObjectPerADC[0] = this;
+    _dmachannel_adc.triggerAtHardwareEvent(DMAMUX_ADC_0); // start DMA channel when ADC finishes a conversion
+    _dmachannel_adc.enable();
+    adc->startContinuous(adc_num);
+  }
   adc->adc[adc_num]->enableDMA();
 #ifdef DEBUG_DUMP_DATA
   dumpDMA_TCD(&_dmachannel_adc);
@@ -179,103 +458,1084 @@ void AnalogBufferDMA::init(ADC *adc, int8_t adc_num)
 
 #endif
 
-  _last_isr_time = millis();
+  _interrupt_count = 0;
+  _adc0_count = 0;
+#ifdef ADC_DUAL_ADCS
+  _adc1_count = 0;
+#endif
+  _buffers_released = 0;
+  _overrun_buffers = 0;
+  _overrun_samples = 0;
+  _sample_count = 0;
+#ifndef KINETISL
+  // make sure the cycle counter is running
+  ARM_DEMCR |= ARM_DEMCR_TRCENA;
+  ARM_DWT_CTRL |= ARM_DWT_CTRL_CYCCNTENA;
+#endif
+  _last_timestamp = timestampTicks();
+  _last_timestamp_ms = millis();
+  _last_isr_time = _last_timestamp_ms;
+  return true;
 }
 
 //=============================================================================
-// stopOnCompletion: allows you to turn on or off stopping when a DMA buffer
-//    has completed filling. Default is on when only one buffer passed in to the
-//    constructor and off if two buffers passed in.
+// halfCompleteMode: split a single buffer in two halves that are filled
+//    circularly by the same DMA transfer, the halves then work just like two
+//    buffers. The DMA raises an interrupt when the first ceil(count/2)
+//    samples are done, so that's the size of the first half.
 //=============================================================================
-void AnalogBufferDMA::stopOnCompletion(bool stop_on_complete)
+void AnalogBufferDMA::halfCompleteMode(bool half_complete)
 {
-#ifndef KINETISL
-  if (stop_on_complete)
-    _dmachannel_adc.TCD->CSR |= DMA_TCD_CSR_DREQ;
-  else
-    _dmachannel_adc.TCD->CSR &= ~DMA_TCD_CSR_DREQ;
-#else
-  if (stop_on_complete)
-    _dmachannel_adc.CFG->DCR |= DMA_DCR_D_REQ;
+  if (half_complete == _half_complete)
+    return;
+  if (half_complete)
+  {
+    if ((_buffer_num != 1) || (_buffer_counts[0] < 2))
+      return;
+    uint16_t count = _buffer_counts[0];
+    _buffer_counts[0] = count - count / 2;
+    _buffers[1] = _buffers[0] + _buffer_counts[0];
+    _buffer_counts[1] = count / 2;
+    _buffer_num = 2;
+  }
   else
-    _dmachannel_adc.CFG->DCR &= ~DMA_DCR_D_REQ;
-#endif
-  _stop_on_completion = stop_on_complete;
+  {
+    _buffer_counts[0] += _buffer_counts[1];
+    _buffer_num = 1;
+  }
+  _half_complete = half_complete;
 }
 
+#ifndef KINETISL
 //=============================================================================
-// ClearCompletion: if we have stop on completion, then clear the completion state
-//                  i.e. reenable the dma operation.  Note only valid if we are
-//                  in the stopOnCompletion state.
+// scanMode: remember the pins to scan, they are checked in init
 //=============================================================================
-bool AnalogBufferDMA::clearCompletion()
+bool AnalogBufferDMA::scanMode(const uint8_t *pins, uint8_t pin_num)
 {
-  if (!_stop_on_completion)
+  if (pin_num > ADC_DMA_MAX_SCAN_PINS)
     return false;
-  // should probably check to see if we are dsiable or not...
-  _dmachannel_adc.enable();
+  for (uint8_t i = 0; i < pin_num; i++)
+    _scan_pins[i] = pins[i];
+  _scan_num = pin_num;
   return true;
 }
 
 //=============================================================================
-// processADC_DMAISR: Process the DMA completion ISR
-//     common for both ISRs on those processors who have more than one ADC
+// initScan: check the pins and buffers and setup the scan DMA channel that
+//     writes the next pin into SC1A/HC0 after each conversion.
 //=============================================================================
-void AnalogBufferDMA::processADC_DMAISR()
+bool AnalogBufferDMA::initScan(ADC *adc, int8_t adc_num)
 {
-  //digitalWriteFast(LED_BUILTIN, !digitalReadFast(LED_BUILTIN));
-  uint32_t cur_time = millis();
+  ADC_Module *adc_module = adc->adc[adc_num];
 
-  _interrupt_count++;
-  _interrupt_delta_time = cur_time - _last_isr_time;
-  _last_isr_time = cur_time;
-  // update the internal buffer positions
-  _dmachannel_adc.clearInterrupt();
-#ifdef KINETISL
-  // Lets try to clear the previous interrupt, change buffers
-  // and restart
-  if (_buffer2 && (_interrupt_count & 1))
+  // the list starts with the second pin, the first one is started by the user
+  uint8_t first_sc1a = adc_module->getSC1A(_scan_pins[0]);
+  for (uint8_t i = 0; i < _scan_num; i++)
   {
-    _dmachannel_adc.destinationBuffer((uint16_t *)_buffer2, _buffer2_count * 2); // 2*b_size is necessary for some reason
+    uint8_t sc1a = adc_module->getSC1A(_scan_pins[(i + 1) % _scan_num]);
+    if (((sc1a & ADC_SC1A_CHANNELS) == ADC_SC1A_PIN_INVALID) ||
+        ((sc1a & ADC_SC1A_PIN_MUX) != (first_sc1a & ADC_SC1A_PIN_MUX)))
+    {
+      adc_module->fail_flag |= ADC_ERROR::WRONG_PIN;
+      return false;
+    }
+    _scan_sc1a[i] = sc1a & ADC_SC1A_CHANNELS;
   }
-  else
+
+  // every buffer starts with the first pin, and linked transfers can only count up to 511
+  uint32_t total_count = 0;
+  for (uint8_t i = 0; i < _buffer_num; i++)
   {
-    _dmachannel_adc.destinationBuffer((uint16_t *)_buffer1, _buffer1_count * 2); // 2*b_size is necessary for some reason
+    total_count = _half_complete ? (total_count + _buffer_counts[i]) : _buffer_counts[i];
+    if ((_buffer_counts[i] % _scan_num) || (total_count > 511))
+    {
+      adc_module->fail_flag |= ADC_ERROR::DMA;
+      return false;
+    }
   }
 
-  // If we are not stopping on completion, then reenable...
-  if (!_stop_on_completion)
-    _dmachannel_adc.enable();
-
+#if defined(__IMXRT1062__)
+  if ((uint32_t)_scan_sc1a >= 0x20200000u)
+    arm_dcache_flush((void *)_scan_sc1a, sizeof(_scan_sc1a));
 #endif
+
+  if (!_dmachannel_scan)
+    _dmachannel_scan = new DMAChannel();
+  _dmachannel_scan->sourceBuffer(_scan_sc1a, _scan_num * 4); // size in bytes
+  _dmachannel_scan->destination(channelADC(adc_num));
+  return true;
 }
+#endif
 
+#ifdef ADC_DUAL_ADCS
 //=============================================================================
-// adc_0_dmaISR: called for first ADC when DMA has completed filling a buffer.
+// initSynchronized: ADC0 DMA fills the even samples of the buffers and a
+//     second DMA channel the odd ones with the ADC1 results, with the same
+//     ring of settings. Each channel interrupts at the end of each buffer and
+//     the later of the two completes it.
 //=============================================================================
-void AnalogBufferDMA::adc_0_dmaISR()
+bool AnalogBufferDMA::initSynchronized(ADC *adc)
 {
-  if (_activeObjectPerADC[0])
+  uint32_t total_count = 0;
+  for (uint8_t i = 0; i < _buffer_num; i++)
   {
-    _activeObjectPerADC[0]->processADC_DMAISR();
+    if ((_buffer_counts[i] & 1) || (_buffers[i] != _buffers[0] + total_count))
+    {
+      adc->adc0->fail_flag |= ADC_ERROR::DMA;
+      return false;
+    }
+    total_count += _buffer_counts[i];
   }
-#if defined(__IMXRT1062__) // Teensy 4.0
-  asm("DSB");
-#endif
+  if (_scan_num || (total_count / 2 > 32767))
+  {
+    adc->adc0->fail_flag |= ADC_ERROR::DMA;
+    return false;
+  }
+
+  _synchronized = true;
+  if (!init(adc, 0))
+  {
+    _synchronized = false;
+    return false;
+  }
+
+  if (!_dmachannel_adc1)
+    _dmachannel_adc1 = new DMAChannel();
+  if (_half_complete)
+  {
+    _dmachannel_adc1->source(sourceADC(1));
+    _dmachannel_adc1->destinationBuffer((uint16_t *)_buffers[0] + 1, total_count * 2);
+    interleaveDestination(*_dmachannel_adc1, total_count);
+    _dmachannel_adc1->interruptAtHalf();
+    _dmachannel_adc1->interruptAtCompletion();
+  }
+  else if (_buffer_num > 1)
+  {
+    for (uint8_t i = 0; i < _buffer_num; i++)
+    {
+      _dmasettings_adc1[i].source(sourceADC(1));
+      _dmasettings_adc1[i].destinationBuffer((uint16_t *)_buffers[i] + 1, _buffer_counts[i] * 2);
+      _dmasettings_adc1[i].replaceSettingsOnCompletion(_dmasettings_adc1[(i + 1) % _buffer_num]);
+      _dmasettings_adc1[i].interruptAtCompletion();
+      interleaveDestination(_dmasettings_adc1[i], _buffer_counts[i]);
+    }
+    *_dmachannel_adc1 = _dmasettings_adc1[0];
+  }
+  else
+  {
+    _dmachannel_adc1->source(sourceADC(1));
+    _dmachannel_adc1->destinationBuffer((uint16_t *)_buffers[0] + 1, total_count * 2);
+    interleaveDestination(*_dmachannel_adc1, total_count);
+    _dmachannel_adc1->interruptAtCompletion();
+    if (_stop_on_completion)
+      _dmachannel_adc1->disableOnCompletion();
+  }
+  _dmachannel_adc1->attachInterrupt(&adc_1_synchronized_dmaISR);
+  _dmachannel_adc1->triggerAtHardwareEvent(DMAMUX_ADC_1); // start DMA channel when ADC1 finishes a conversion
+  _dmachannel_adc1->enable();
+
+  adc->adc1->continuousMode();
+  adc->adc1->enableDMA();
+  return true;
 }
+#endif
 
+#ifndef KINETISL
 //=============================================================================
-// adc_1_dmaISR - Used for processors that have a second ADC object
+// attachADC: trigger the DMA channel with the ADC and get its interrupts
 //=============================================================================
-void AnalogBufferDMA::adc_1_dmaISR()
+void AnalogBufferDMA::attachADC(int8_t adc_num)
 {
-  if (_activeObjectPerADC[1])
+  _capture_buffer = nullptr;
+  if (adc_num == 1)
   {
-    _activeObjectPerADC[1]->processADC_DMAISR();
+#ifdef ADC_DUAL_ADCS
+    _dmachannel_adc.attachInterrupt(&adc_1_dmaISR);
+    if (_preparing)
+      return;
+    _activeObjectPerADC[1] = this;
+    _dmachannel_adc.triggerAtHardwareEvent(dmamuxADC(1)); // start DMA channel when ADC finishes a conversion
+#endif
   }
-#if defined(__IMXRT1062__) // Teensy 4.0
-  asm("DSB");
+  else
+  {
+    _dmachannel_adc.attachInterrupt(&adc_0_dmaISR);
+    if (_preparing)
+      return;
+    _activeObjectPerADC[0] = this;
+    _dmachannel_adc.triggerAtHardwareEvent(dmamuxADC(0)); // start DMA channel when ADC finishes a conversion
+  }
+}
+
+//=============================================================================
+// dmamuxADC: DMAMUX source that starts the transfers for the ADC
+//=============================================================================
+uint8_t AnalogBufferDMA::dmamuxADC(int8_t adc_num)
+{
+#if defined(__IMXRT1062__)
+  if (_chain_num)
+    return DMAMUX_SOURCE_ADC_ETC;
+#endif
+#ifdef ADC_DUAL_ADCS
+  return (adc_num == 1) ? DMAMUX_ADC_1 : DMAMUX_ADC_0;
+#else
+  (void)adc_num;
+  return DMAMUX_ADC_0;
 #endif
 }
 
+#if defined(__IMXRT1062__)
+//=============================================================================
+// chainMode: the transfers read the results of an ADC_ETC chain
+//=============================================================================
+bool AnalogBufferDMA::chainMode(uint8_t chain_num)
+{
+  if (chain_num > 8)
+    return false;
+  _chain_num = chain_num;
+  return true;
+}
+#endif
+
+//=============================================================================
+// initCapture: one shot capture of count samples, any size. The chunks are
+//     ping-ponged between two settings, the ISR programs the idle one with
+//     the chunk after the next one.
+//=============================================================================
+bool AnalogBufferDMA::initCapture(ADC *adc, int8_t adc_num, volatile uint16_t *buffer, uint32_t count)
+{
+  // the chunks read R0 of one ADC, they can't follow the other modes
+  bool other_mode = _scan_num || _synchronized;
+#ifdef KINETISK
+  other_mode = other_mode || _ping_pong;
+#endif
+#if defined(__IMXRT1062__)
+  other_mode = other_mode || _chain_num;
+#endif
+  if (!buffer || !count || other_mode)
+  {
+    adc->adc[adc_num]->fail_flag |= ADC_ERROR::DMA;
+    return false;
+  }
+#if defined(__IMXRT1062__)
+  if (bufferCached(buffer))
+  {
+    if ((((uint32_t)buffer | (count * 2)) & 31) != 0)
+    {
+      adc->adc[adc_num]->fail_flag |= ADC_ERROR::DMA;
+      return false;
+    }
+    arm_dcache_flush_delete((void *)buffer, count * 2);
+  }
+#endif
+
+  attachADC(adc_num);
+  _capture_buffer = buffer;
+  _capture_count = count;
+  _capture_done = 0;
+  _capture_programmed = 0;
+  _interrupt_count = 0;
+  for (uint8_t i = 0; i < 2; i++)
+  {
+    _dmasettings_adc[i].source(sourceADC(adc_num));
+    if (_capture_programmed < _capture_count)
+      captureChunk(i);
+  }
+  _dmachannel_adc = _dmasettings_adc[0];
+  _stop_on_completion = true;
+  _dmachannel_adc.enable();
+
+  adc->adc[adc_num]->continuousMode();
+  adc->adc[adc_num]->enableDMA();
+
+  _last_timestamp = timestampTicks();
+  _last_timestamp_ms = millis();
+  _last_isr_time = _last_timestamp_ms;
+  return true;
+}
+
+//=============================================================================
+// captureChunk: program the setting with the next chunk of the capture
+//=============================================================================
+void AnalogBufferDMA::captureChunk(uint8_t setting)
+{
+  DMASetting &dma_setting = _dmasettings_adc[setting];
+  uint32_t chunk = _capture_count - _capture_programmed;
+  if (chunk > ADC_DMA_CAPTURE_CHUNK)
+    chunk = ADC_DMA_CAPTURE_CHUNK;
+
+  dma_setting.destinationBuffer((uint16_t *)_capture_buffer + _capture_programmed, chunk * 2); // size in bytes
+  dma_setting.TCD->CSR = 0;
+  dma_setting.interruptAtCompletion();
+  _capture_programmed += chunk;
+  if (_capture_programmed < _capture_count)
+    dma_setting.replaceSettingsOnCompletion(_dmasettings_adc[setting ^ 1]);
+  else
+    dma_setting.disableOnCompletion(); // last one
+}
+#endif
+
+#ifdef KINETISL
+//=============================================================================
+// initGapless: the ADC channel writes the buffer circularly (DMOD) and when
+//     each half is done a linked channel writes the byte count of the next
+//     half into it, so the transfer never stops waiting for the ISR.
+//=============================================================================
+bool AnalogBufferDMA::initGapless()
+{
+  uint32_t bytes = (_buffer_counts[0] + _buffer_counts[1]) * 2;
+  uint8_t dmod = 0;
+  for (uint32_t size = 16; size <= bytes; size <<= 1)
+  {
+    dmod++;
+    if (size == bytes)
+      break;
+  }
+  if ((_buffer_counts[0] != _buffer_counts[1]) || (bytes < 16) || ((16u << (dmod - 1)) != bytes) ||
+      ((uint32_t)_buffers[0] & (bytes - 1)))
+    return false;
+
+  if (!_dmachannel_reload)
+    _dmachannel_reload = new DMAChannel();
+
+  // one 32 bit write of the half buffer byte count (and clear DONE) every time it's linked
+  _reload_bcr = DMA_DSR_BCR_DONE | DMA_DSR_BCR_BCR(bytes / 2);
+  _dmachannel_reload->CFG->SAR = &_reload_bcr;
+  _dmachannel_reload->CFG->DAR = &_dmachannel_adc.CFG->DSR_BCR;
+  _dmachannel_reload->CFG->DSR_BCR = DMA_DSR_BCR_BCR(0xFFFFC);
+  _dmachannel_reload->CFG->DCR = DMA_DCR_CS | DMA_DCR_SSIZE(0) | DMA_DCR_DSIZE(0);
+
+  _dmachannel_adc.destinationBuffer((uint16_t *)_buffers[0], bytes / 2);
+  _dmachannel_adc.CFG->DCR = (_dmachannel_adc.CFG->DCR & ~(DMA_DCR_D_REQ | DMA_DCR_DMOD(15))) | DMA_DCR_DMOD(dmod) |
+                             DMA_DCR_LINKCC(3) | DMA_DCR_LCH1(_dmachannel_reload->channel);
+  _stop_on_completion = false;
+  return true;
+}
+#endif
+
+//=============================================================================
+// prepare: setup the DMA like init, without starting it or taking over the
+//     ADC, switchTo starts it later.
+//=============================================================================
+bool AnalogBufferDMA::prepare(ADC *adc, int8_t adc_num, uint8_t pin, uint32_t timer_frequency)
+{
+#ifdef ADC_DUAL_ADCS
+  uint8_t num = (adc_num == 1) ? 1 : 0;
+#else
+  uint8_t num = 0;
+#endif
+  if (adc->adc[num]->getSC1A(pin) == ADC_SC1A_PIN_INVALID)
+  {
+    adc->adc[num]->fail_flag |= ADC_ERROR::WRONG_PIN;
+    return false;
+  }
+  if (_activeObjectPerADC[num] == this)
+    return false; // running, switch to another one first
+
+  _preparing = true;
+  bool ok = init(adc, num);
+  _preparing = false;
+  _pin = pin;
+  _timer_frequency = timer_frequency;
+  return ok;
+}
+
+//=============================================================================
+// switchTo: make this object the running one on its ADC. The running object
+//     is stopped at the end of its current buffer and its ISR hands the ADC
+//     over, if it's already stopped it's done right away.
+//=============================================================================
+bool AnalogBufferDMA::switchTo()
+{
+  if (!_adc || _capture_buffer || _synchronized)
+    return false;
+#ifdef ADC_USE_TIMER
+  if (_timer_frequency && !_adc->adc[_adc_num]->isTimerFrequencyAvailable(_timer_frequency))
+  {
+    _adc->adc[_adc_num]->fail_flag |= ADC_ERROR::OTHER;
+    return false;
+  }
+#endif
+
+  const uint32_t primask = atomic::disableInterrupts();
+  AnalogBufferDMA *running = _activeObjectPerADC[_adc_num];
+  if ((running == this) || (running && (running->_capture_buffer || running->_synchronized)))
+  {
+    atomic::restoreInterrupts(primask);
+    return false;
+  }
+  if (!running)
+  {
+    if (!activate())
+    {
+      atomic::restoreInterrupts(primask);
+      return false;
+    }
+  }
+  else
+  {
+    running->_switch_next = this;
+    if (channelRunning(running->_dmachannel_adc))
+    {
+#ifndef KINETISL
+      running->_dmachannel_adc.TCD->CSR |= DMA_TCD_CSR_DREQ;
+#else
+      running->_dmachannel_adc.CFG->DCR |= DMA_DCR_D_REQ;
+#endif
+    }
+    else if (!interruptPending(running->_dmachannel_adc) && !running->handOver())
+    {
+      atomic::restoreInterrupts(primask);
+      return false;
+    }
+  }
+  atomic::restoreInterrupts(primask);
+  return true;
+}
+
+//=============================================================================
+// handOver: this object stopped at the end of a buffer, start the next one.
+//     The DMA keeps its position, so it resumes with the next buffer if it's
+//     switched to again. Returns false if the next one couldn't start, the
+//     ADC then stays stopped and ADC_ERROR::DMA is set so that's not silent.
+//=============================================================================
+bool AnalogBufferDMA::handOver()
+{
+  AnalogBufferDMA *next = _switch_next;
+  _switch_next = nullptr;
+#ifndef KINETISL
+  if (!_stop_on_completion)
+    _dmachannel_adc.TCD->CSR &= ~DMA_TCD_CSR_DREQ;
+#else
+  if (_half_complete)
+    _dmachannel_adc.CFG->DCR &= ~DMA_DCR_D_REQ;
+#endif
+  releaseTrigger(_dmachannel_adc);
+  if (!next->activate())
+  {
+    _adc->adc[_adc_num]->fail_flag |= ADC_ERROR::DMA;
+    return false;
+  }
+  return true;
+}
+
+//=============================================================================
+// activate: set the pin and rate of this object and start its DMA,
+//     returns false (and doesn't start) if the rate can't be set
+//=============================================================================
+bool AnalogBufferDMA::activate()
+{
+  ADC_Module *adc_module = _adc->adc[_adc_num];
+#ifdef ADC_USE_TIMER
+  if (_timer_frequency && !adc_module->setTimerFrequency(_timer_frequency))
+    return false;
+#endif
+  if (_pin != 0xFF)
+    adc_module->setTriggeredPin(_pin);
+  // drop a result of the previous pin, it would be the first sample
+  adc_module->analogReadContinuous();
+
+  // the timestamps continue from the ones of the last run of this object
+  extendTimestamp(timestampTicks());
+  _last_isr_time = millis();
+  _activeObjectPerADC[_adc_num] = this;
+#ifndef KINETISL
+  _dmachannel_adc.triggerAtHardwareEvent(dmamuxADC(_adc_num));
+#else
+  _dmachannel_adc.triggerAtHardwareEvent(DMAMUX_ADC_0);
+#endif
+  _dmachannel_adc.enable();
+  return true;
+}
+
+//=============================================================================
+// stopOnCompletion: allows you to turn on or off stopping when a DMA buffer
+//    has completed filling. Default is on when only one buffer passed in to the
+//    constructor and off if two buffers passed in.
+//=============================================================================
+void AnalogBufferDMA::stopOnCompletion(bool stop_on_complete)
+{
+#ifndef KINETISL
+  if (stop_on_complete)
+    _dmachannel_adc.TCD->CSR |= DMA_TCD_CSR_DREQ;
+  else
+    _dmachannel_adc.TCD->CSR &= ~DMA_TCD_CSR_DREQ;
+#ifdef ADC_DUAL_ADCS
+  if (_dmachannel_adc1)
+  {
+    if (stop_on_complete)
+      _dmachannel_adc1->TCD->CSR |= DMA_TCD_CSR_DREQ;
+    else
+      _dmachannel_adc1->TCD->CSR &= ~DMA_TCD_CSR_DREQ;
+  }
+#endif
+#else
+  if (stop_on_complete)
+    _dmachannel_adc.CFG->DCR |= DMA_DCR_D_REQ;
+  else
+    _dmachannel_adc.CFG->DCR &= ~DMA_DCR_D_REQ;
+#endif
+  _stop_on_completion = stop_on_complete;
+}
+
+//=============================================================================
+// ClearCompletion: if we have stop on completion, then clear the completion state
+//                  i.e. reenable the dma operation.  Note only valid if we are
+//                  in the stopOnCompletion state.
+//=============================================================================
+bool AnalogBufferDMA::clearCompletion()
+{
+  if (!_stop_on_completion)
+    return false;
+  // should probably check to see if we are dsiable or not...
+#ifdef ADC_DUAL_ADCS
+  if (_dmachannel_adc1)
+    _dmachannel_adc1->enable();
+#endif
+  _dmachannel_adc.enable();
+  return true;
+}
+
+//=============================================================================
+// buffersAvailable: number of filled buffers not yet released by the consumer.
+//     If the consumer fell a whole ring behind the DMA has overwritten the
+//     oldest ones, so skip them. One slot is always being written by the DMA.
+//     With a single buffer that slot is the only one, keep the last filled
+//     buffer available, like bufferLastISRFilled, the DMA is rewriting it.
+//=============================================================================
+uint8_t AnalogBufferDMA::buffersAvailable()
+{
+  uint32_t filled = _interrupt_count;
+  uint32_t released = _buffers_released;
+  if (!_stop_on_completion && (filled - released > buffersKept()))
+  {
+    released = filled - buffersKept();
+    _buffers_released = released;
+  }
+  return filled - released;
+}
+
+//=============================================================================
+// acquireBuffer: oldest filled buffer, or nullptr if there are none.
+//     The buffer belongs to the consumer until releaseBuffer is called.
+//=============================================================================
+volatile uint16_t *AnalogBufferDMA::acquireBuffer()
+{
+  if (!buffersAvailable())
+    return nullptr;
+  return _buffers[_buffers_released % _buffer_num];
+}
+
+//=============================================================================
+// releaseBuffer: give the acquired buffer back to the DMA.
+//=============================================================================
+void AnalogBufferDMA::releaseBuffer()
+{
+  if (_buffers_released == _interrupt_count)
+    return;
+  __asm__ volatile("dmb" ::: "memory"); // finish reading the buffer before it's handed back
+  _buffers_released = _buffers_released + 1;
+}
+
+//=============================================================================
+// peek: the buffer the DMA is filling and the number of samples it already
+//     wrote in it, from the channel's destination address. That's read again
+//     if the ISR ran meanwhile, and if the DMA already moved on to the next
+//     buffer (the ISR is pending) the buffer is full.
+//=============================================================================
+volatile uint16_t *AnalogBufferDMA::peek(uint16_t *count)
+{
+  uint32_t interrupt_count;
+  volatile uint16_t *start;
+  uint16_t written;
+  do
+  {
+    interrupt_count = _interrupt_count;
+    uint8_t current = interrupt_count % _buffer_num;
+    start = _buffers[current];
+    written = _buffer_counts[current];
+#ifndef KINETISL
+    volatile uint16_t *dest = (volatile uint16_t *)_dmachannel_adc.destinationAddress();
+#else
+    volatile uint16_t *dest = (volatile uint16_t *)_dmachannel_adc.CFG->DAR;
+#endif
+    if ((dest >= start) && (dest < start + written))
+      written = dest - start;
+#ifdef ADC_DUAL_ADCS
+    if (_dmachannel_adc1)
+    {
+      // the ADC1 results go in between, only count complete pairs
+      volatile uint16_t *dest1 = (volatile uint16_t *)_dmachannel_adc1->destinationAddress();
+      if ((dest1 > start) && (dest1 <= start + written))
+        written = dest1 - start - 1;
+      written &= ~1;
+    }
+#endif
+  } while (interrupt_count != _interrupt_count);
+
+#if defined(__IMXRT1062__)
+  if (written && bufferCached(start))
+    arm_dcache_delete((void *)start, written * 2);
+#endif
+  if (count)
+    *count = written;
+  return start;
+}
+
+#ifndef KINETISL
+//=============================================================================
+// captureCount: samples captured so far, including the chunk being filled
+//=============================================================================
+uint32_t AnalogBufferDMA::captureCount()
+{
+  if (!_capture_buffer || captureComplete())
+    return _capture_done;
+
+  uint32_t done;
+  uint32_t written;
+  do
+  {
+    done = _capture_done;
+    written = (volatile uint16_t *)_dmachannel_adc.destinationAddress() - _capture_buffer;
+  } while (done != _capture_done);
+
+  if ((written < done) || (written > _capture_count))
+    written = done; // finished, or between chunks
+#if defined(__IMXRT1062__)
+  if ((written > done) && bufferCached(_capture_buffer))
+    arm_dcache_delete((void *)(_capture_buffer + done), (written - done) * 2);
+#endif
+  return written;
+}
+#endif
+
+//=============================================================================
+// timestampFrequency: ticks per second of the buffer timestamps
+//=============================================================================
+uint32_t AnalogBufferDMA::timestampFrequency()
+{
+#if defined(__IMXRT1062__)
+  return F_CPU_ACTUAL;
+#elif defined(KINETISK)
+  return F_CPU;
+#else
+  return 1000000;
+#endif
+}
+
+//=============================================================================
+// extendTimestamp: extend the tick counter to 64 bits. The counter can wrap
+//     several times between buffers (every 2^32 / F_CPU, ~7 s at 600 MHz),
+//     so the wraps are counted from millis(). It's off by at most a few
+//     milliseconds, far less than a wrap, and only wraps after ~49 days.
+//=============================================================================
+uint64_t AnalogBufferDMA::extendTimestamp(uint32_t ticks)
+{
+  uint32_t ms = millis();
+  uint32_t delta = ticks - (uint32_t)_last_timestamp;
+  uint64_t expected = (uint64_t)(ms - _last_timestamp_ms) * (timestampFrequency() / 1000);
+  uint64_t wraps = 0;
+  if (expected > delta)
+    wraps = (expected - delta + 0x80000000u) >> 32; // rounded to the nearest wrap
+  _last_timestamp += (wraps << 32) + delta;
+  _last_timestamp_ms = ms;
+  return _last_timestamp;
+}
+
+//=============================================================================
+// resetOverrun: clear the dropped buffers and samples counters
+//=============================================================================
+void AnalogBufferDMA::resetOverrun()
+{
+  __disable_irq();
+  _overrun_buffers = 0;
+  _overrun_samples = 0;
+  __enable_irq();
+}
+
+//=============================================================================
+// attachCallback: deliver each filled buffer to the callback, from the DMA ISR
+//    or from a software interrupt triggered by it.
+//=============================================================================
+void AnalogBufferDMA::attachCallback(AnalogBufferDMACallback callback, bool deferred)
+{
+  _callback_deferred = deferred;
+  if (deferred)
+  {
+    _callback_event.setContext(this);
+    _callback_event.attachInterrupt(&deferredCallback);
+  }
+  _callback = callback;
+}
+
+void AnalogBufferDMA::detachCallback()
+{
+  _callback = nullptr;
+  _callback_event.detach();
+}
+
+//=============================================================================
+// deliverBuffers: hand all the filled buffers to the callback and release them
+//=============================================================================
+void AnalogBufferDMA::deliverBuffers()
+{
+  volatile uint16_t *buffer;
+  while (_callback && (buffer = acquireBuffer()) != nullptr)
+  {
+    uint8_t index = _buffers_released % _buffer_num;
+    _callback(buffer, _buffer_counts[index], _buffer_timestamps[index], _buffers_released);
+    releaseBuffer();
+  }
+}
+
+void AnalogBufferDMA::deferredCallback(EventResponderRef event)
+{
+  ((AnalogBufferDMA *)event.getContext())->deliverBuffers();
+}
+
+//=============================================================================
+// armTrigger: start looking for the trigger in the filled buffers
+//=============================================================================
+bool AnalogBufferDMA::armTrigger(ADC_DMA_TRIGGER trigger, int32_t level, uint32_t pre_samples, uint32_t post_samples)
+{
+  // the DMA already started overwriting the oldest buffer when it's stopped
+  if ((_buffer_num < 2) && !_stop_on_completion)
+    return false;
+  // the window must fit in the buffers kept when the DMA stops. The trigger can be anywhere in its
+  // buffer, so the post trigger samples can end up to a buffer minus one sample into the last one.
+  uint16_t min_count = _buffer_counts[0];
+  uint16_t max_count = _buffer_counts[0];
+  for (uint8_t i = 1; i < _buffer_num; i++)
+  {
+    if (_buffer_counts[i] < min_count)
+      min_count = _buffer_counts[i];
+    if (_buffer_counts[i] > max_count)
+      max_count = _buffer_counts[i];
+  }
+  uint32_t capacity = (uint32_t)(_stop_on_completion ? 1 : _buffer_num - 1) * min_count;
+  uint32_t slack = _stop_on_completion ? 0 : max_count - 1;
+  if ((uint64_t)pre_samples + post_samples + slack > capacity)
+    return false;
+  // after a trigger the DMA stopped in the middle of the next buffer, restart it at its start
+  bool restart = (_trigger_state == TRIGGER_DONE) && !_stop_on_completion;
+  // only the ring of settings can go back to the start of a buffer, the other modes need init
+  if (restart && _half_complete)
+    return false;
+#ifndef KINETISL
+  if (restart && (_scan_num || _synchronized))
+    return false;
+#endif
+
+  _trigger_state = TRIGGER_IDLE;
+  _trigger = trigger;
+  _trigger_level = level;
+  _trigger_prev = level; // no edge on the first sample
+  _trigger_pre = pre_samples;
+  _trigger_post = post_samples;
+  __asm__ volatile("dmb" ::: "memory");
+  _trigger_state = TRIGGER_ARMED;
+  if (restart)
+  {
+#ifndef KINETISL
+    // drop the samples of the partial buffer, _sample_count still points to its start
+    _dmachannel_adc = _dmasettings_adc[_interrupt_count % _buffer_num];
+#endif
+    // and the result converted while the DMA was stopped
+    if (_adc)
+      _adc->adc[_adc_num]->analogReadContinuous();
+  }
+  if (!_stop_on_completion)
+  {
+#ifdef ADC_DUAL_ADCS
+    if (_dmachannel_adc1)
+      _dmachannel_adc1->enable();
+#endif
+    _dmachannel_adc.enable();
+  }
+  return true;
+}
+
+//=============================================================================
+// checkTrigger: called from the ISR with the buffer just filled. Look for the
+//     trigger and stop the DMA once the post trigger samples are done.
+//=============================================================================
+void AnalogBufferDMA::checkTrigger(uint8_t filled)
+{
+  volatile uint16_t *buffer = _buffers[filled];
+  uint16_t count = _buffer_counts[filled];
+  uint64_t first_sample = _buffer_first_samples[filled];
+
+  if (_trigger_state == TRIGGER_ARMED)
+  {
+    int32_t prev = _trigger_prev;
+    for (uint16_t i = 0; i < count; i++)
+    {
+      int32_t value = _signed ? (int32_t)(int16_t)buffer[i] : (int32_t)buffer[i];
+      bool fired;
+      switch (_trigger)
+      {
+      case ADC_DMA_TRIGGER::ABOVE:
+        fired = value >= _trigger_level;
+        break;
+      case ADC_DMA_TRIGGER::BELOW:
+        fired = value <= _trigger_level;
+        break;
+      case ADC_DMA_TRIGGER::RISING:
+        fired = (prev < _trigger_level) && (value >= _trigger_level);
+        break;
+      default: // FALLING
+        fired = (prev > _trigger_level) && (value <= _trigger_level);
+        break;
+      }
+      if (fired)
+      {
+        _trigger_sample = first_sample + i;
+        _trigger_state = TRIGGER_TRIGGERED;
+        break;
+      }
+      prev = value;
+    }
+    _trigger_prev = _signed ? (int32_t)(int16_t)buffer[count - 1] : (int32_t)buffer[count - 1];
+  }
+
+  if ((_trigger_state == TRIGGER_TRIGGERED) && (first_sample + count >= _trigger_sample + _trigger_post))
+  {
+    _dmachannel_adc.disable();
+#ifdef ADC_DUAL_ADCS
+    if (_dmachannel_adc1)
+      _dmachannel_adc1->disable();
+#endif
+    _trigger_last_buffer = _interrupt_count - 1;
+    _trigger_state = TRIGGER_DONE;
+  }
+}
+
+//=============================================================================
+// triggerOldestBuffer: number of the oldest buffer not overwritten
+//     when the DMA was stopped.
+//=============================================================================
+uint32_t AnalogBufferDMA::triggerOldestBuffer()
+{
+  uint32_t kept = _stop_on_completion ? 0 : _buffer_num - 2;
+  return (_trigger_last_buffer > kept) ? _trigger_last_buffer - kept : 0;
+}
+
+//=============================================================================
+// triggerWindowStart: first sample of the window still in the ring
+//=============================================================================
+uint64_t AnalogBufferDMA::triggerWindowStart()
+{
+  uint64_t oldest_sample = _buffer_first_samples[triggerOldestBuffer() % _buffer_num];
+  uint64_t start = (_trigger_sample > _trigger_pre) ? _trigger_sample - _trigger_pre : 0;
+  return (start > oldest_sample) ? start : oldest_sample;
+}
+
+uint32_t AnalogBufferDMA::triggerPreSamples()
+{
+  if (_trigger_state != TRIGGER_DONE)
+    return 0;
+  uint64_t start = triggerWindowStart();
+  return (_trigger_sample > start) ? _trigger_sample - start : 0;
+}
+
+//=============================================================================
+// triggerWindowSegment: part of the pre/post trigger window in one buffer.
+//     Segments are returned in order, oldest first.
+//=============================================================================
+volatile uint16_t *AnalogBufferDMA::triggerWindowSegment(uint8_t segment, uint16_t *count)
+{
+  if (_trigger_state != TRIGGER_DONE)
+    return nullptr;
+
+  uint64_t start = triggerWindowStart();
+  uint64_t end = _trigger_sample + _trigger_post;
+  for (uint32_t b = triggerOldestBuffer(); b <= _trigger_last_buffer; b++)
+  {
+    uint8_t slot = b % _buffer_num;
+    uint64_t buffer_start = _buffer_first_samples[slot];
+    uint64_t buffer_end = buffer_start + _buffer_counts[slot];
+    uint64_t seg_start = (start > buffer_start) ? start : buffer_start;
+    uint64_t seg_end = (end < buffer_end) ? end : buffer_end;
+    if (seg_start >= seg_end)
+      continue;
+    if (segment-- == 0)
+    {
+      *count = seg_end - seg_start;
+      return _buffers[slot] + (seg_start - buffer_start);
+    }
+  }
+  return nullptr;
+}
+
+//=============================================================================
+// processADC_DMAISR: Process the DMA completion ISR
+//     common for both ISRs on those processors who have more than one ADC
+//=============================================================================
+void AnalogBufferDMA::processADC_DMAISR()
+{
+  //digitalWriteFast(LED_BUILTIN, !digitalReadFast(LED_BUILTIN));
+  uint64_t timestamp = extendTimestamp(timestampTicks());
+
+#ifndef KINETISL
+  if (_capture_buffer)
+  {
+    // a chunk of the capture is done, its setting is free for the chunk after the next one
+    uint32_t chunk = _capture_count - _capture_done;
+    if (chunk > ADC_DMA_CAPTURE_CHUNK)
+      chunk = ADC_DMA_CAPTURE_CHUNK;
+#if defined(__IMXRT1062__)
+    if (bufferCached(_capture_buffer))
+      arm_dcache_delete((void *)(_capture_buffer + _capture_done), chunk * 2);
+#endif
+    _capture_done += chunk;
+    if (_capture_programmed < _capture_count)
+      captureChunk(_interrupt_count & 1);
+
+    uint32_t cur_time = millis();
+    _interrupt_count++;
+    _interrupt_delta_time = cur_time - _last_isr_time;
+    _last_isr_time = cur_time;
+    _dmachannel_adc.clearInterrupt();
+    return;
+  }
+#endif
+
+  uint8_t filled = _adc0_count % _buffer_num;
+  _buffer_timestamps[filled] = timestamp;
+  _buffer_first_samples[filled] = _sample_count;
+  _sample_count += _buffer_counts[filled];
+  _adc0_count++;
+  _dmachannel_adc.clearInterrupt();
+  completeBuffers();
+}
+
+#ifdef ADC_DUAL_ADCS
+//=============================================================================
+// processADC1_DMAISR: the ADC1 channel of synchronized mode wrote its last
+//     result in a buffer
+//=============================================================================
+void AnalogBufferDMA::processADC1_DMAISR()
+{
+  _adc1_count++;
+  _dmachannel_adc1->clearInterrupt();
+  completeBuffers();
+}
+#endif
+
+//=============================================================================
+// completeBuffers: hand over the buffers both channels are done with, in
+//     synchronized mode that's when the later of ADC0 and ADC1 finishes.
+//=============================================================================
+void AnalogBufferDMA::completeBuffers()
+{
+  uint32_t done = _adc0_count;
+#ifdef ADC_DUAL_ADCS
+  if (_synchronized && (_adc1_count < done))
+    done = _adc1_count;
+#endif
+  if (_interrupt_count == done)
+    return; // the other channel completes it
+
+  while (_interrupt_count != done)
+  {
+    uint8_t filled = _interrupt_count % _buffer_num;
+#if defined(__IMXRT1062__)
+    // drop any stale cache lines so the consumer reads what the DMA wrote
+    if (bufferCached(_buffers[filled]))
+      arm_dcache_delete((void *)_buffers[filled], _buffer_counts[filled] * 2);
+#endif
+    _interrupt_count++;
+
+    // the DMA is now filling the oldest buffer of the ring, was it released?
+    if (!_stop_on_completion && (_interrupt_count - _buffers_released > buffersKept()))
+    {
+      _overrun_buffers++;
+      _overrun_samples += _buffer_counts[_interrupt_count % _buffer_num];
+    }
+    if ((_trigger_state == TRIGGER_ARMED) || (_trigger_state == TRIGGER_TRIGGERED))
+      checkTrigger(filled);
+  }
+  uint32_t cur_time = millis();
+  _interrupt_delta_time = cur_time - _last_isr_time;
+  _last_isr_time = cur_time;
+
+  // update the internal buffer positions
+#ifdef KINETISL
+  if (_half_complete)
+  {
+    // the reload channel already restarted the transfer, make sure it can keep doing it
+    _dmachannel_reload->CFG->DSR_BCR = DMA_DSR_BCR_BCR(0xFFFFC);
+  }
+  else
+  {
+    // Lets try to clear the previous interrupt, change to the next buffer in the ring
+    // and restart
+    uint8_t next = _interrupt_count % _buffer_num;
+    _dmachannel_adc.destinationBuffer((uint16_t *)_buffers[next], _buffer_counts[next] * 2); // 2*b_size is necessary for some reason
+
+    // If we are not stopping on completion, then reenable...
+    if (!_stop_on_completion && (_trigger_state != TRIGGER_DONE) && !_switch_next)
+      _dmachannel_adc.enable();
+  }
+#endif
+
+  // the DMA stopped at the end of this buffer, the next object takes over the ADC
+  if (_switch_next && !channelRunning(_dmachannel_adc))
+    handOver();
+
+  // the DMA is already filling the next buffer
+  if (_callback)
+  {
+    if (_callback_deferred)
+      _callback_event.triggerEvent();
+    else
+      deliverBuffers();
+  }
+}
+
+//=============================================================================
+// adc_0_dmaISR: called for first ADC when DMA has completed filling a buffer.
+//=============================================================================
+void AnalogBufferDMA::adc_0_dmaISR()
+{
+  if (_activeObjectPerADC[0])
+  {
+    _activeObjectPerADC[0]->processADC_DMAISR();
+  }
+#if defined(__IMXRT1062__) // Teensy 4.0
+  asm("DSB");
+#endif
+}
+
+//=============================================================================
+// adc_1_dmaISR - Used for processors that have a second ADC object
+//=============================================================================
+void AnalogBufferDMA::adc_1_dmaISR()
+{
+  if (_activeObjectPerADC[1])
+  {
+    _activeObjectPerADC[1]->processADC_DMAISR();
+  }
+#if defined(__IMXRT1062__) // Teensy 4.0
+  asm("DSB");
+#endif
+}
+
+#ifdef ADC_DUAL_ADCS
+//=============================================================================
+// adc_1_synchronized_dmaISR: ADC1 channel of the synchronized object, which
+//     is the active object of ADC0
+//=============================================================================
+void AnalogBufferDMA::adc_1_synchronized_dmaISR()
+{
+  if (_activeObjectPerADC[0] && _activeObjectPerADC[0]->_dmachannel_adc1)
+  {
+    _activeObjectPerADC[0]->processADC1_DMAISR();
+  }
+#if defined(__IMXRT1062__) // Teensy 4.0
+  asm("DSB");
+#endif
+}
+#endif
+
 #endif // ADC_USE_DMA
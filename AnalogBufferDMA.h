@@ -28,17 +28,47 @@
 #define ANALOGBUFFERDMA_H
 
 #include "DMAChannel.h"
+#include "EventResponder.h"
 #include "ADC.h"
 
 #ifdef ADC_USE_DMA
 
+// Maximum number of buffers that can be chained in a DMA ring.
+// Each one costs a DMASetting, define it before including this file to change it.
+#ifndef ADC_DMA_MAX_BUFFERS
+#define ADC_DMA_MAX_BUFFERS 8
+#endif
+
+#ifndef ADC_DMA_CAPTURE_CHUNK
+// Samples per DMA major loop in captures, at most 32767 and a multiple of 16 (cache lines).
+#define ADC_DMA_CAPTURE_CHUNK 32752
+#endif
+
+// Maximum number of pins in scan mode, enough for the tables of ADC_Scheduler.
+#ifndef ADC_DMA_MAX_SCAN_PINS
+#define ADC_DMA_MAX_SCAN_PINS 32
+#endif
+
+// Called with each filled buffer, its count, timestamp (see AnalogBufferDMA::timestampFrequency)
+// and sequence number (number of buffers filled before, a gap means buffers were dropped).
+typedef void (*AnalogBufferDMACallback)(volatile uint16_t *buffer, uint16_t count, uint64_t timestamp, uint32_t sequence);
+
+// Software trigger condition tested on every sample of the filled buffers
+enum class ADC_DMA_TRIGGER : uint8_t
+{
+    ABOVE,   // sample >= level
+    BELOW,   // sample <= level
+    RISING,  // crosses level going up
+    FALLING, // crosses level going down
+};
+
 // lets wrap some of our Dmasettings stuff into helper class
 class AnalogBufferDMA
 {
     // keep our settings and the like:
 public: // At least temporary to play with dma settings.
 #ifndef KINETISL
-    DMASetting _dmasettings_adc[2];
+    DMASetting _dmasettings_adc[ADC_DMA_MAX_BUFFERS];
 #endif
     DMAChannel _dmachannel_adc;
 
@@ -46,36 +76,276 @@ public: // At least temporary to play with dma settings.
     static void adc_0_dmaISR();
     static void adc_1_dmaISR();
     void processADC_DMAISR();
+    void completeBuffers();
+#ifdef ADC_DUAL_ADCS
+    static void adc_1_synchronized_dmaISR();
+    void processADC1_DMAISR();
+#endif
+    void checkTrigger(uint8_t filled);
+    uint32_t triggerOldestBuffer();
+    uint64_t triggerWindowStart();
+    void deliverBuffers();
+    static void deferredCallback(EventResponderRef event);
+    bool handOver();
+    bool activate();
+    uint64_t extendTimestamp(uint32_t ticks);
+#ifndef KINETISL
+    bool initScan(ADC *adc, int8_t adc_num);
+    void attachADC(int8_t adc_num);
+    uint8_t dmamuxADC(int8_t adc_num);
+    void captureChunk(uint8_t setting);
+#else
+    bool initGapless();
+#endif
 
 public:
     AnalogBufferDMA(volatile uint16_t *buffer1, uint16_t buffer1_count,
-                    volatile uint16_t *buffer2 = nullptr, uint16_t buffer2_count = 0) : _buffer1(buffer1), _buffer1_count(buffer1_count), _buffer2(buffer2), _buffer2_count(buffer2_count){};
+                    volatile uint16_t *buffer2 = nullptr, uint16_t buffer2_count = 0);
+
+    // Ring of buffer_num buffers of buffer_count samples each, filled in order and continuously.
+    AnalogBufferDMA(volatile uint16_t *const *buffers, uint8_t buffer_num, uint16_t buffer_count);
+
+    // Signed buffers, for differential (and PGA) conversions that are two's complement.
+    // Use the *Signed accessors to get them, trigger levels are compared as signed values.
+    AnalogBufferDMA(volatile int16_t *buffer1, uint16_t buffer1_count,
+                    volatile int16_t *buffer2 = nullptr, uint16_t buffer2_count = 0);
+    AnalogBufferDMA(volatile int16_t *const *buffers, uint8_t buffer_num, uint16_t buffer_count);
+    inline bool isSigned() { return _signed; }
+    inline bool isSynchronized() { return _synchronized; }
+
+    // On Teensy 4 buffers in cached memory (DMAMEM) must be 32-byte aligned and a multiple of 32 bytes,
+    // their cache is invalidated for you when they are filled. Returns false on error.
+    bool init(ADC *adc, int8_t adc_num = -1);
+
+    // Single buffer only, call before init: the buffer is used circularly and
+    // each half is handed over (as a buffer of half the size) as soon as it's full.
+    // On Teensy LC this is the gapless mode: the size in bytes must be a power of two (at least 16)
+    // and the buffer aligned to it, a second DMA channel restarts the first one without the CPU.
+    void halfCompleteMode(bool half_complete);
+    inline bool halfCompleteMode(void) { return _half_complete; }
+
+#ifndef KINETISL
+
+    // Scan mode, call before init: after each conversion a second DMA channel starts the next pin
+    // of the list, so the buffers contain the pins interleaved: pins[0], pins[1], ..., pins[0], ...
+    // Start the conversions on pins[0] as usual after init. All pins must use the same mux on Teensy 3.x.
+    // The buffer sizes must be multiples of pin_num and at most 511 samples (DMA channel linking limit).
+    // Not with the QuadTimer on Teensy 4, that uses the ADC_ETC to select the pin.
+    bool scanMode(const uint8_t *pins, uint8_t pin_num);
+    inline uint8_t scanPinNum() { return _scan_num; }
+    DMAChannel *_dmachannel_scan = nullptr;
+
+    // One shot capture of count samples into buffer instead of init, for example
+    // a few MB in the Teensy 4.1 PSRAM. The DMA fills it without gaps in chunks.
+    // Only a single pin: returns false in scan, ping-pong, chain or synchronized mode.
+    bool initCapture(ADC *adc, int8_t adc_num, volatile uint16_t *buffer, uint32_t count);
+    inline bool initCapture(ADC *adc, int8_t adc_num, volatile int16_t *buffer, uint32_t count)
+    {
+        _signed = true;
+        return initCapture(adc, adc_num, (volatile uint16_t *)buffer, count);
+    }
+    inline bool captureComplete() { return _capture_buffer && (_capture_done == _capture_count); }
+    uint32_t captureCount(); // samples captured so far, including the chunk being filled
+#endif
+
+#if defined(__IMXRT1062__)
+    // Chain mode, call before init: for the chains of up to 8 pins of ADC_Module::startQuadTimerChain,
+    // each trigger the DMA reads all the results from the ADC_ETC, so the buffers contain the pins
+    // interleaved. The buffer counts must be multiples of chain_num, 0 turns it off.
+    // Only one ADC at a time, the ADC_ETC has one DMA request for all triggers.
+    bool chainMode(uint8_t chain_num);
+    inline uint8_t chainPinNum() { return _chain_num; }
+#endif
+
+#ifdef KINETISK
+    // Ping-pong mode, call before init: the DMA reads RA and RB in turns, for the two conversions per period
+    // of ADC_Module::startPDBPingPong. The buffers contain (pinA, pinB) pairs, their counts must be even.
+    inline void pingPongMode(bool ping_pong) { _ping_pong = ping_pong; }
+    inline bool pingPongMode(void) { return _ping_pong; }
+#endif
 
-    void init(ADC *adc, int8_t adc_num = -1);
+#ifdef ADC_DUAL_ADCS
+    // Synchronized mode, instead of init: the results of both ADCs go into the same buffers as (adc0, adc1) pairs.
+    // The buffers must be contiguous in memory (a ring made from one array, or half complete mode) and
+    // their counts even. Start both ADCs after with adc->startSynchronizedContinuous or a timer on each.
+    // Each ADC has its own DMA channel, a buffer is only counted and handed over (bufferLastISRFilled,
+    // acquireBuffer, callback) once the later of the two wrote its last result, at any rate.
+    bool initSynchronized(ADC *adc);
+    DMAChannel *_dmachannel_adc1 = nullptr;
+    DMASetting _dmasettings_adc1[ADC_DMA_MAX_BUFFERS];
+#endif
+
+    // Several objects, each with its own buffers, pin and timer frequency, can share an ADC.
+    // prepare sets up the DMA like init but doesn't start it, switchTo makes this object the running one
+    // as soon as the running object finishes the buffer it's filling, without teardown or re-init.
+    // timer_frequency = 0 keeps the current rate. Not with captures or synchronized mode.
+    // switchTo returns false if the rate can't be set, on Teensy 3.x the PDB is shared by both ADCs
+    // and its rate can't change while it also triggers the other ADC. If the rate can't be set when the
+    // running object finishes its buffer (in its ISR) the ADC stops and ADC_ERROR::DMA is set on it.
+    bool prepare(ADC *adc, int8_t adc_num, uint8_t pin, uint32_t timer_frequency = 0);
+    bool switchTo();
+    inline bool active() { return _activeObjectPerADC[_adc_num] == this; }
 
     void stopOnCompletion(bool stop_on_complete);
     inline bool stopOnCompletion(void) { return _stop_on_completion; }
     bool clearCompletion();
-    inline volatile uint16_t *bufferLastISRFilled() { return (!_buffer2 || (_interrupt_count & 1)) ? _buffer1 : _buffer2; }
-    inline uint16_t bufferCountLastISRFilled() { return (!_buffer2 || (_interrupt_count & 1)) ? _buffer1_count : _buffer2_count; }
+    inline volatile uint16_t *bufferLastISRFilled() { return _buffers[(_interrupt_count - 1) % _buffer_num]; }
+    inline volatile int16_t *bufferLastISRFilledSigned() { return (volatile int16_t *)bufferLastISRFilled(); }
+    inline uint16_t bufferCountLastISRFilled() { return _buffer_counts[(_interrupt_count - 1) % _buffer_num]; }
+    // Timestamp (in timestampFrequency ticks) of the completion of the last buffer filled
+    // and index of its first sample since init. The cycle counter (micros on LC) is extended to 64 bits
+    // with millis(), buffers can take any time up to a millis() wrap (~49 days) between them.
+    inline uint64_t bufferTimestampLastISRFilled() { return _buffer_timestamps[(_interrupt_count - 1) % _buffer_num]; }
+    inline uint64_t bufferFirstSampleLastISRFilled() { return _buffer_first_samples[(_interrupt_count - 1) % _buffer_num]; }
+    uint32_t timestampFrequency();
     inline uint32_t interruptCount() { return _interrupt_count; }
     inline uint32_t interruptDeltaTime() { return _interrupt_delta_time; }
     inline bool interrupted() { return _interrupt_delta_time != 0; }
-    inline void clearInterrupt() { _interrupt_delta_time = 0; }
+    inline void clearInterrupt()
+    {
+        _interrupt_delta_time = 0;
+        _buffers_released = _interrupt_count; // done with every filled buffer
+    }
     inline void userData(uint32_t new_data) { _user_data = new_data; }
     inline uint32_t userData(void) { return _user_data; }
 
+    // Producer/consumer handoff: the DMA ISR produces filled buffers, the consumer
+    // acquires the oldest one, processes it and releases it, in order.
+    // Only one consumer is supported, it doesn't need to disable interrupts.
+    // With a single buffer in continuous mode the DMA is already rewriting the acquired buffer,
+    // use at least two to process whole buffers.
+    inline uint8_t bufferNum() { return _buffer_num; }
+    uint8_t buffersAvailable();
+    volatile uint16_t *acquireBuffer();
+    inline volatile int16_t *acquireBufferSigned() { return (volatile int16_t *)acquireBuffer(); }
+    inline uint16_t bufferCountAcquired() { return _buffer_counts[_buffers_released % _buffer_num]; }
+    inline uint64_t bufferTimestampAcquired() { return _buffer_timestamps[_buffers_released % _buffer_num]; }
+    inline uint64_t bufferFirstSampleAcquired() { return _buffer_first_samples[_buffers_released % _buffer_num]; }
+    inline uint32_t bufferSequenceAcquired() { return _buffers_released; } // number of the buffer since init
+    void releaseBuffer();
+
+    // Progress of the buffer being filled, to read fresh data from big buffers before they complete:
+    // peek returns it and sets count to the samples already written in it (also in sync and scan modes).
+    volatile uint16_t *peek(uint16_t *count);
+    inline volatile int16_t *peekSigned(uint16_t *count) { return (volatile int16_t *)peek(count); }
+    inline uint16_t samplesAvailable()
+    {
+        uint16_t count;
+        peek(&count);
+        return count;
+    }
+
+    // Overruns: the DMA started overwriting a buffer that wasn't released yet
+    inline bool overrun() { return _overrun_buffers != 0; }
+    inline uint32_t droppedBuffers() { return _overrun_buffers; }
+    inline uint32_t droppedSamples() { return _overrun_samples; }
+    void resetOverrun();
+
+    // Deliver the filled buffers to the callback instead of polling, directly from the DMA ISR,
+    // or deferred to a low priority software interrupt. The buffer is released when it returns,
+    // so don't use acquireBuffer/releaseBuffer (or clearInterrupt) at the same time.
+    void attachCallback(AnalogBufferDMACallback callback, bool deferred = false);
+    void detachCallback();
+
+    // Pre-trigger capture: test the filled buffers for the trigger, and once post_samples more samples
+    // are filled stop the DMA. The ring then holds the pre_samples before the trigger and the post_samples
+    // after it. They must fit in bufferNum()-1 buffers (one with stop on completion) with room for a buffer
+    // less one sample, as the trigger can be anywhere in its buffer, or armTrigger returns false.
+    // Arm again to restart: the DMA starts again at the beginning of the next buffer, the conversions
+    // done while it was stopped aren't in the buffers nor counted in the sample indices, so the indices
+    // are only continuous until the trigger; use the buffer timestamps to place the buffers in time. In half complete (also Teensy LC), scan or
+    // synchronized mode armTrigger returns false after a trigger, call init again before arming.
+    bool armTrigger(ADC_DMA_TRIGGER trigger, int32_t level, uint32_t pre_samples, uint32_t post_samples);
+    inline void disarmTrigger() { _trigger_state = TRIGGER_IDLE; }
+    inline bool triggered() { return _trigger_state >= TRIGGER_TRIGGERED; }
+    inline bool triggerComplete() { return _trigger_state == TRIGGER_DONE; }
+    // The window is spread over the buffers of the ring: get each segment in order until it returns nullptr.
+    volatile uint16_t *triggerWindowSegment(uint8_t segment, uint16_t *count);
+    inline volatile int16_t *triggerWindowSegmentSigned(uint8_t segment, uint16_t *count)
+    {
+        return (volatile int16_t *)triggerWindowSegment(segment, count);
+    }
+    uint32_t triggerPreSamples(); // samples in the window before the trigger sample
+    inline uint64_t triggerSample() { return _trigger_sample; } // index since init of the trigger sample
+
 protected:
-    volatile uint32_t _interrupt_count = 0;
+    volatile uint32_t _interrupt_count = 0; // also the number of buffers filled so far
+    volatile uint32_t _adc0_count = 0;      // buffers the ADC0 channel completed
+#ifdef ADC_DUAL_ADCS
+    volatile uint32_t _adc1_count = 0; // and the ADC1 channel in synchronized mode
+#endif
     volatile uint32_t _interrupt_delta_time;
     volatile uint32_t _last_isr_time;
 
-    volatile uint16_t *_buffer1;
-    uint16_t _buffer1_count;
-    volatile uint16_t *_buffer2;
-    uint16_t _buffer2_count;
+    volatile uint16_t *_buffers[ADC_DMA_MAX_BUFFERS];
+    uint16_t _buffer_counts[ADC_DMA_MAX_BUFFERS];
+    uint8_t _buffer_num;
+    // filled buffers the DMA isn't writing, the single buffer is kept while it's rewritten
+    inline uint8_t buffersKept() { return (_buffer_num > 1) ? _buffer_num - 1 : 1; }
+    volatile uint32_t _buffers_released = 0; // number of buffers released by the consumer
+    volatile uint32_t _overrun_buffers = 0;
+    volatile uint32_t _overrun_samples = 0;
+
+    // per buffer completion timestamps and sample indexes
+    volatile uint64_t _buffer_timestamps[ADC_DMA_MAX_BUFFERS];
+    volatile uint64_t _buffer_first_samples[ADC_DMA_MAX_BUFFERS];
+    uint64_t _sample_count = 0;
+    uint64_t _last_timestamp = 0;    // tick counter extended to 64 bits
+    uint32_t _last_timestamp_ms = 0; // millis() at _last_timestamp, to count its wraps
     uint32_t _user_data = 0;
     bool _stop_on_completion = false;
+    bool _half_complete = false;
+    bool _signed = false;
+
+#ifndef KINETISL
+    uint8_t _scan_pins[ADC_DMA_MAX_SCAN_PINS];
+    volatile uint32_t _scan_sc1a[ADC_DMA_MAX_SCAN_PINS]; // channel list the scan DMA writes into SC1A
+#endif
+    uint8_t _scan_num = 0;
+#ifdef KINETISK
+    bool _ping_pong = false;
+#endif
+#if defined(__IMXRT1062__)
+    uint8_t _chain_num = 0;
+#endif
+
+#ifdef KINETISL
+    DMAChannel *_dmachannel_reload = nullptr; // reloads the byte count of the ADC channel in gapless mode
+    uint32_t _reload_bcr;
+#endif
+
+    volatile uint16_t *_capture_buffer = nullptr;
+    uint32_t _capture_count = 0;
+    volatile uint32_t _capture_done = 0;
+    uint32_t _capture_programmed = 0;
+    bool _synchronized = false;
+
+    AnalogBufferDMACallback _callback = nullptr;
+    bool _callback_deferred = false;
+    EventResponder _callback_event;
+
+    enum : uint8_t
+    {
+        TRIGGER_IDLE,
+        TRIGGER_ARMED,
+        TRIGGER_TRIGGERED,
+        TRIGGER_DONE
+    };
+    volatile uint8_t _trigger_state = TRIGGER_IDLE;
+    ADC_DMA_TRIGGER _trigger;
+    int32_t _trigger_level;
+    int32_t _trigger_prev;
+    uint32_t _trigger_pre;
+    uint32_t _trigger_post;
+    uint64_t _trigger_sample = 0;
+    uint32_t _trigger_last_buffer; // number of the last buffer filled before stopping
+
+    ADC *_adc = nullptr;
+    uint8_t _adc_num = 0;
+    uint8_t _pin = 0xFF; // converted when switched to, 0xFF keeps the current one
+    uint32_t _timer_frequency = 0;
+    bool _preparing = false;
+    AnalogBufferDMA *volatile _switch_next = nullptr; // hand the ADC over to it at the end of the buffer
 };
 
 #endif // ADC_USE_DMA
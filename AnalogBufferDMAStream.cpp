@@ -0,0 +1,87 @@
+/* Teensy 3.x, LC, 4.0 ADC library
+   https://github.com/pedvide/ADC
+   Copyright (c) 2020 Pedro Villanueva
+
+   Permission is hereby granted, free of charge, to any person obtaining
+   a copy of this software and associated documentation files (the
+   "Software"), to deal in the Software without restriction, including
+   without limitation the rights to use, copy, modify, merge, publish,
+   distribute, sublicense, and/or sell copies of the Software, and to
+   permit persons to whom the Software is furnished to do so, subject to
+   the following conditions:
+
+   The above copyright notice and this permission notice shall be
+   included in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+   MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+   NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+   BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+   ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+   CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+   SOFTWARE.
+*/
+
+#include "AnalogBufferDMAStream.h"
+
+#ifdef ADC_USE_DMA
+
+AnalogBufferDMAStream::AnalogBufferDMAStream(AnalogBufferDMA &abdma, uint8_t channel, Print &port)
+    : _abdma(abdma), _port(port), _channel(channel)
+{
+}
+
+//=============================================================================
+// update: write a header and then the samples of each filled buffer, the
+//     buffer is only released once the port has them.
+//=============================================================================
+uint8_t AnalogBufferDMAStream::update()
+{
+  uint8_t sent = 0;
+  volatile uint16_t *buffer;
+  while ((buffer = _abdma.acquireBuffer()) != nullptr)
+  {
+    ADC_StreamHeader header;
+    header.magic = ADC_STREAM_MAGIC;
+    header.version = ADC_STREAM_VERSION;
+    header.channel = _channel;
+    header.flags = _abdma.isSigned() ? ADC_STREAM_FLAG_SIGNED : 0;
+    uint32_t dropped = _abdma.droppedBuffers();
+    if (dropped > _dropped_buffers)
+      header.flags |= ADC_STREAM_FLAG_OVERRUN;
+    _dropped_buffers = dropped;
+    header.header_size = sizeof(header);
+    header.sequence = _abdma.bufferSequenceAcquired();
+    header.count = _abdma.bufferCountAcquired();
+    header.interleave = 1;
+#ifndef KINETISL
+    if (_abdma.scanPinNum())
+      header.interleave = _abdma.scanPinNum();
+#endif
+#ifdef KINETISK
+    if (_abdma.pingPongMode())
+      header.interleave = 2;
+#endif
+#if defined(__IMXRT1062__)
+    if (_abdma.chainPinNum())
+      header.interleave = _abdma.chainPinNum();
+#endif
+    if (_abdma.isSynchronized())
+      header.interleave = 2;
+    header.timestamp = _abdma.bufferTimestampAcquired();
+    header.timestamp_frequency = _abdma.timestampFrequency();
+    header.header_crc = 0;
+    header.reserved = 0;
+    header.header_crc = adcStreamCRC16((const uint8_t *)&header, sizeof(header));
+
+    _port.write((const uint8_t *)&header, sizeof(header));
+    _port.write((const uint8_t *)buffer, header.count * 2);
+    _abdma.releaseBuffer();
+    _frames_sent++;
+    sent++;
+  }
+  return sent;
+}
+
+#endif // ADC_USE_DMA
@@ -0,0 +1,56 @@
+/* Teensy 3.x, LC, 4.0 ADC library
+ * https://github.com/pedvide/ADC
+ * Copyright (c) 2020 Pedro Villanueva
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef ANALOGBUFFERDMASTREAM_H
+#define ANALOGBUFFERDMASTREAM_H
+
+#include "AnalogBufferDMA.h"
+#include "ADC_stream.h"
+
+#ifdef ADC_USE_DMA
+
+// Sends the buffers filled by an AnalogBufferDMA as binary frames (see ADC_stream.h) to a port,
+// Serial for the USB serial. The samples are written straight from the DMA buffers, there's no
+// copy or formatting. extras/adc_stream has a decoder for the host.
+class AnalogBufferDMAStream
+{
+public:
+    AnalogBufferDMAStream(AnalogBufferDMA &abdma, uint8_t channel, Print &port = Serial);
+
+    // Send the filled buffers, one frame each, call it often from loop. Returns the frames sent.
+    uint8_t update();
+    inline uint32_t framesSent() { return _frames_sent; }
+    inline uint8_t channel() { return _channel; }
+
+protected:
+    AnalogBufferDMA &_abdma;
+    Print &_port;
+    uint8_t _channel;
+    uint32_t _frames_sent = 0;
+    uint32_t _dropped_buffers = 0; // already flagged in a frame
+};
+
+#endif // ADC_USE_DMA
+#endif
@@ -379,6 +379,29 @@ __attribute__((always_inline)) inline volatile bool getBitFlag(volatile T &reg,
 
 #endif
 
+/**
+ * @brief Disable the interrupts and return the previous PRIMASK
+ *
+ * Pass it to restoreInterrupts at the end of the critical section, so a
+ * function called with the interrupts already disabled doesn't enable them
+ * in the middle of its caller's critical section, as __enable_irq() would.
+ * @return PRIMASK before disabling the interrupts
+ */
+__attribute__((always_inline)) inline uint32_t disableInterrupts() {
+  uint32_t primask;
+  __asm__ volatile("mrs %0, primask\n" : "=r"(primask)::"memory");
+  __disable_irq();
+  return primask;
+}
+
+/**
+ * @brief Restore the interrupts as they were before disableInterrupts
+ * @param primask the value returned by disableInterrupts
+ */
+__attribute__((always_inline)) inline void restoreInterrupts(uint32_t primask) {
+  __asm__ volatile("msr primask, %0\n" ::"r"(primask) : "memory");
+}
+
 } // namespace atomic
 
 #endif // ADC_ATOMIC_H
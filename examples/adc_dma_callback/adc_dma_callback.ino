@@ -0,0 +1,74 @@
+/* Example for processing DMA buffers in a callback
+    Valid for the current Teensy 3.x, LC and 4.0.
+
+  DMA: AnalogBufferDMA calls bufferFilled as soon as each buffer is full,
+  from a low priority software interrupt (deferred = true), so the processing
+  doesn't depend on how long loop() takes. With deferred = false it's called
+  directly from the DMA interrupt.
+  The loop just prints the results.
+*/
+
+#include <ADC.h>
+
+#ifdef ADC_USE_DMA
+
+#include <AnalogBufferDMA.h>
+
+const int readPin_adc_0 = A0;
+
+ADC *adc = new ADC(); // adc object
+
+#ifdef KINETISL
+const uint32_t buffer_size = 256;
+#else
+const uint32_t buffer_size = 1024;
+#endif
+DMAMEM static volatile uint16_t __attribute__((aligned(32)))
+dma_adc_buff1[buffer_size];
+DMAMEM static volatile uint16_t __attribute__((aligned(32)))
+dma_adc_buff2[buffer_size];
+AnalogBufferDMA abdma(dma_adc_buff1, buffer_size, dma_adc_buff2, buffer_size);
+
+volatile uint32_t last_average = 0;
+volatile uint32_t last_sequence = 0;
+volatile uint32_t last_timestamp = 0;
+
+void bufferFilled(volatile uint16_t *buffer, uint16_t count,
+                  uint64_t timestamp, uint32_t sequence) {
+  uint32_t sum_values = 0;
+  for (uint16_t i = 0; i < count; i++) {
+    sum_values += buffer[i];
+  }
+  last_average = sum_values / count;
+  last_sequence = sequence;
+  last_timestamp = timestamp / (abdma.timestampFrequency() / 1000);
+}
+
+void setup() {
+  Serial.begin(9600);
+  while (!Serial && millis() < 5000)
+    ;
+
+  pinMode(readPin_adc_0, INPUT_DISABLE);
+
+  adc->adc0->setAveraging(8);   // set number of averages
+  adc->adc0->setResolution(12); // set bits of resolution
+
+  abdma.attachCallback(bufferFilled, true);
+  abdma.init(adc, ADC_0);
+
+  adc->adc0->startContinuous(readPin_adc_0);
+
+  Serial.println("End Setup");
+}
+
+void loop() {
+  Serial.printf("Buffer %u at %u ms: %u\n", last_sequence, last_timestamp,
+                last_average);
+  delay(500);
+}
+
+#else  // make sure the example can run for any boards (automated testing)
+void setup() {}
+void loop() {}
+#endif // ADC_USE_DMA
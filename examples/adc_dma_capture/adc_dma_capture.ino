@@ -0,0 +1,86 @@
+/* Example for a long one shot capture with DMA
+    Valid for the current Teensy 3.x and 4.x.
+
+  DMA: AnalogBufferDMA::initCapture fills a buffer of any size without gaps,
+  chaining DMA transfers internally. On the Teensy 4.1 with PSRAM the buffer
+  can be several MB. A timer sets the sampling rate.
+  When the capture is done some statistics are printed.
+*/
+
+#include <ADC.h>
+#include <ADC_util.h>
+
+#if defined(ADC_USE_DMA) && defined(ADC_USE_TIMER) && !defined(KINETISL)
+
+#include <AnalogBufferDMA.h>
+
+const int readPin_adc_0 = A0;
+
+ADC *adc = new ADC(); // adc object
+
+#if defined(ARDUINO_TEENSY41)
+const uint32_t capture_size = 2 * 1024 * 1024; // needs PSRAM
+EXTMEM static volatile uint16_t __attribute__((aligned(32)))
+capture_buffer[capture_size];
+#elif defined(ADC_TEENSY_4)
+const uint32_t capture_size = 200000;
+DMAMEM static volatile uint16_t __attribute__((aligned(32)))
+capture_buffer[capture_size];
+#else
+const uint32_t capture_size = 20000;
+static volatile uint16_t capture_buffer[capture_size];
+#endif
+
+DMAMEM static volatile uint16_t __attribute__((aligned(32))) dummy_buffer[16];
+AnalogBufferDMA abdma(dummy_buffer, 16); // the capture uses its own buffer
+
+void setup() {
+  Serial.begin(9600);
+  while (!Serial && millis() < 5000)
+    ;
+
+  pinMode(readPin_adc_0, INPUT_DISABLE);
+
+  adc->adc0->setAveraging(1);
+  adc->adc0->setResolution(12);
+  adc->adc0->setConversionSpeed(ADC_CONVERSION_SPEED::HIGH_SPEED);
+  adc->adc0->setSamplingSpeed(ADC_SAMPLING_SPEED::HIGH_SPEED);
+
+  if (!abdma.initCapture(adc, ADC_0, capture_buffer, capture_size)) {
+    Serial.print("Error: ");
+    Serial.println(getStringADCError(adc->adc0->fail_flag));
+    return;
+  }
+
+  adc->adc0->startSingleRead(readPin_adc_0);
+  adc->adc0->startTimer(100000); // frequency in Hz
+
+  Serial.printf("Capturing %u samples\n", capture_size);
+}
+
+void loop() {
+  static bool printed = false;
+  if (!printed && abdma.captureComplete()) {
+    adc->adc0->stopTimer();
+
+    uint16_t min_val = 0xffff, max_val = 0;
+    uint64_t sum_values = 0;
+    for (uint32_t i = 0; i < capture_size; i++) {
+      uint16_t value = capture_buffer[i];
+      min_val = min(min_val, value);
+      max_val = max(max_val, value);
+      sum_values += value;
+    }
+    Serial.printf("Done in %u chunks: %u <= %u <= %u\n", abdma.interruptCount(),
+                  min_val, (uint32_t)(sum_values / capture_size), max_val);
+    printed = true;
+  } else if (!printed) {
+    Serial.printf("%u samples\n", abdma.captureCount());
+    delay(500);
+  }
+}
+
+#else  // make sure the example can run for any boards (automated testing)
+void setup() {}
+void loop() {}
+#endif // ADC_USE_TIMER and DMA
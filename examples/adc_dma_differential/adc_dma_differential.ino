@@ -0,0 +1,74 @@
+/* Example for streaming differential measurements with DMA
+    Valid for the Teensy 3.x and LC (boards with differential pins).
+
+  DMA: differential results are two's complement, so the buffers are int16_t
+  and AnalogBufferDMA is created with the signed constructor. Each buffer is
+  processed with the signed accessors and the minimum, maximum, average and
+  RMS values are printed.
+*/
+
+#include <ADC.h>
+
+#if defined(ADC_USE_DMA) && ADC_DIFF_PAIRS > 0
+
+#include <AnalogBufferDMA.h>
+
+ADC *adc = new ADC(); // adc object
+
+#ifdef KINETISL
+const uint32_t buffer_size = 256;
+#else
+const uint32_t buffer_size = 1024;
+#endif
+DMAMEM static volatile int16_t __attribute__((aligned(32)))
+dma_adc_buff1[buffer_size];
+DMAMEM static volatile int16_t __attribute__((aligned(32)))
+dma_adc_buff2[buffer_size];
+AnalogBufferDMA abdma(dma_adc_buff1, buffer_size, dma_adc_buff2, buffer_size);
+
+void setup() {
+  Serial.begin(9600);
+  while (!Serial && millis() < 5000)
+    ;
+
+  pinMode(A10, INPUT_DISABLE); // Diff Channel 0 Positive
+  pinMode(A11, INPUT_DISABLE); // Diff Channel 0 Negative
+
+  adc->adc0->setAveraging(8);   // set number of averages
+  adc->adc0->setResolution(16); // set bits of resolution
+
+  abdma.init(adc, ADC_0);
+  adc->adc0->startContinuousDifferential(A10, A11);
+
+  Serial.println("End Setup");
+}
+
+void loop() {
+  volatile int16_t *pbuffer;
+  while ((pbuffer = abdma.acquireBufferSigned()) != nullptr) {
+    uint16_t count = abdma.bufferCountAcquired();
+    int16_t min_val = INT16_MAX;
+    int16_t max_val = INT16_MIN;
+    int32_t sum_values = 0;
+    float sum_sq = 0;
+    for (uint16_t i = 0; i < count; i++) {
+      int16_t value = pbuffer[i];
+      if (value < min_val)
+        min_val = value;
+      if (value > max_val)
+        max_val = value;
+      sum_values += value;
+      sum_sq += (float)value * value;
+    }
+    abdma.releaseBuffer();
+
+    Serial.printf("%d <= %d <= %d, RMS: %d\n", min_val,
+                  (int)(sum_values / (int32_t)count), max_val,
+                  (int)sqrtf(sum_sq / count));
+  }
+}
+
+#else  // make sure the example can run for any boards (automated testing)
+void setup() {}
+void loop() {}
+#endif // ADC_USE_DMA and differential pins
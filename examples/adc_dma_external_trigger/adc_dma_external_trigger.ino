@@ -0,0 +1,89 @@
+/* Example for triggering the ADC with the edges of a pin using DMA
+    Valid for the current Teensy 3.x and 4.x.
+
+  Trigger:
+    On Teensy 3.x the trigger pin is the external trigger input of the PDB,
+    pin 11 or 15.
+
+    On Teensy 4, the XBAR connects the pin to the ADC_ETC, pins 0-5, 7 or 8.
+
+  Each rising edge of the trigger pin (an encoder, a zero crossing detector of
+  the line...) converts readPin delay_us later, without any interrupt per
+  sample. The samples are collected with AnalogBufferDMA.
+  To try it connect the trigger pin to pwm_pin, it has a 1 kHz PWM.
+  The number of samples per second and their average are printed.
+*/
+
+#include <ADC.h>
+#include <ADC_util.h>
+
+#if defined(ADC_USE_DMA) && (defined(ADC_USE_PDB) || defined(ADC_TEENSY_4))
+
+#include <AnalogBufferDMA.h>
+
+const int readPin = A0;
+#ifdef ADC_TEENSY_4
+const uint8_t trigger_pin = 2;
+#else
+const uint8_t trigger_pin = 11;
+#endif
+const uint8_t pwm_pin = 9;
+const uint32_t delay_us = 10; // from the edge to the conversion
+
+ADC *adc = new ADC(); // adc object
+
+const uint32_t buffer_size = 100;
+DMAMEM static volatile uint16_t __attribute__((aligned(32)))
+dma_adc_buff1[buffer_size];
+DMAMEM static volatile uint16_t __attribute__((aligned(32)))
+dma_adc_buff2[buffer_size];
+AnalogBufferDMA abdma(dma_adc_buff1, buffer_size, dma_adc_buff2, buffer_size);
+
+elapsedMillis elapsed_since_print;
+uint32_t samples = 0, sum = 0;
+
+void setup() {
+  Serial.begin(9600);
+  while (!Serial && millis() < 5000)
+    ;
+
+  analogWriteFrequency(pwm_pin, 1000);
+  analogWrite(pwm_pin, 128);
+
+  pinMode(readPin, INPUT_DISABLE);
+  adc->adc0->setAveraging(1);   // set number of averages
+  adc->adc0->setResolution(12); // set bits of resolution
+
+  abdma.init(adc, ADC_0);
+
+  adc->adc0->startSingleRead(readPin); // call this to setup everything
+                                       // before the trigger starts
+  if (!adc->adc0->startExternalTrigger(trigger_pin, delay_us)) {
+    Serial.print("Error: ");
+    Serial.println(getStringADCError(adc->adc0->fail_flag));
+  }
+}
+
+void loop() {
+  volatile uint16_t *pbuffer;
+  while ((pbuffer = abdma.acquireBuffer()) != nullptr) {
+    uint16_t count = abdma.bufferCountAcquired();
+    for (uint16_t i = 0; i < count; i++) {
+      sum += pbuffer[i];
+    }
+    samples += count;
+    abdma.releaseBuffer();
+  }
+
+  if (elapsed_since_print > 1000) {
+    Serial.printf("%u samples, average %u\n", samples,
+                  samples ? sum / samples : 0);
+    samples = sum = 0;
+    elapsed_since_print = 0;
+  }
+}
+
+#else  // make sure the example can run for any boards (automated testing)
+void setup() {}
+void loop() {}
+#endif // ADC_USE_DMA and a trigger input
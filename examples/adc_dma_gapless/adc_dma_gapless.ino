@@ -0,0 +1,139 @@
+/* Example that checks that no samples are lost between DMA buffers
+    Valid for the Teensy LC, 3.x and 4.0, it's mostly useful for the LC.
+
+  DMA: AnalogBufferDMA in half complete mode. On the Teensy LC a second DMA
+  channel restarts the transfer when each half is full, so the ADC keeps
+  being read while the ISR runs. On the other boards the DMA does that itself.
+
+  Test: an IntervalTimer starts one conversion per period, test_samples of
+  them, so the DMA must have written exactly test_samples samples at the end.
+  The conversions alternate between VREFH and VREFL (Teensy LC and 3.x) and
+  the loop checks that pattern in each half, so a sample lost or repeated at
+  the boundary between halves shifts it. Teensy 4 has no low reference, there
+  only the count is checked. It prints PASS or FAIL.
+  Raise sample_rate to stress the handoff, each conversion must end within
+  a period.
+*/
+
+#include <ADC.h>
+#include <ADC_util.h>
+#include <IntervalTimer.h>
+
+#ifdef ADC_USE_DMA
+
+#include <AnalogBufferDMA.h>
+
+ADC *adc = new ADC(); // adc object
+
+// the size in bytes must be a power of 2 and the buffer aligned to it
+const uint32_t buffer_size = 256;
+DMAMEM static volatile uint16_t __attribute__((aligned(512)))
+dma_adc_buff[buffer_size];
+AnalogBufferDMA abdma(dma_adc_buff, buffer_size);
+
+const uint32_t sample_rate = 50000;             // Hz
+const uint32_t test_samples = 10 * sample_rate; // 10 seconds
+
+#if defined(ADC_TEENSY_4)
+const uint8_t pattern_pins[2] = {(uint8_t)ADC_INTERNAL_SOURCE::VREFSH,
+                                 (uint8_t)ADC_INTERNAL_SOURCE::VREFSH};
+const bool check_pattern = false;
+#else
+const uint8_t pattern_pins[2] = {(uint8_t)ADC_INTERNAL_SOURCE::VREFH,
+                                 (uint8_t)ADC_INTERNAL_SOURCE::VREFL};
+const bool check_pattern = true;
+#endif
+
+IntervalTimer timer;
+volatile uint32_t conversions_started = 0;
+uint64_t first_sample = 0; // index since init of the first sample of the test
+uint32_t pattern_errors = 0;
+bool test_done = false;
+
+// one conversion per period, alternating high and low
+void timerCallback() {
+  if (conversions_started == test_samples) {
+    timer.end();
+    return;
+  }
+  adc->adc0->startReadFast(pattern_pins[conversions_started & 1]);
+  conversions_started++;
+}
+
+// samples the DMA wrote since init: the filled halves and the current one
+uint64_t samplesWritten() {
+  uint32_t halves;
+  uint16_t count;
+  do {
+    halves = abdma.interruptCount();
+    count = abdma.samplesAvailable();
+  } while (halves != abdma.interruptCount());
+  return (uint64_t)halves * (buffer_size / 2) + count;
+}
+
+void setup() {
+  Serial.begin(9600);
+  while (!Serial && millis() < 5000)
+    ;
+
+  adc->adc0->setAveraging(1);
+  adc->adc0->setResolution(12);
+  adc->adc0->setConversionSpeed(ADC_CONVERSION_SPEED::HIGH_SPEED);
+  adc->adc0->setSamplingSpeed(ADC_SAMPLING_SPEED::HIGH_SPEED);
+
+  abdma.halfCompleteMode(true);
+  if (!abdma.init(adc, ADC_0)) {
+    Serial.print("Error: ");
+    Serial.println(getStringADCError(adc->adc0->fail_flag));
+    test_done = true;
+    return;
+  }
+  // the timer starts each conversion
+  adc->adc0->stopContinuous();
+  adc->adc0->singleMode();
+  delay(1);
+  while (abdma.acquireBuffer()) {
+    abdma.releaseBuffer();
+  }
+  first_sample = samplesWritten();
+  abdma.resetOverrun();
+
+  timer.begin(timerCallback, 1000000.0f / sample_rate);
+  Serial.printf("Converting %u samples at %u Hz\n", test_samples, sample_rate);
+}
+
+void loop() {
+  volatile uint16_t *buffer;
+  while ((buffer = abdma.acquireBuffer()) != nullptr) {
+    uint64_t index = abdma.bufferFirstSampleAcquired();
+    uint16_t count = abdma.bufferCountAcquired();
+    for (uint16_t i = 0; i < count; i++, index++) {
+      if (!check_pattern || (index < first_sample) ||
+          (index >= first_sample + test_samples)) {
+        continue;
+      }
+      bool high = buffer[i] > adc->adc0->getMaxValue() / 2;
+      if (high != (((index - first_sample) & 1) == 0)) {
+        pattern_errors++;
+      }
+    }
+    abdma.releaseBuffer();
+  }
+
+  if (!test_done && (conversions_started == test_samples)) {
+    delay(1); // the last conversion
+    uint64_t written = samplesWritten() - first_sample;
+    bool pass = (written == test_samples) && (pattern_errors == 0) &&
+                (abdma.droppedSamples() == 0);
+    Serial.printf("Samples: %u of %u, pattern errors: %u, dropped: %u\n",
+                  (uint32_t)written, test_samples, pattern_errors,
+                  abdma.droppedSamples());
+    Serial.println(pass ? "PASS" : "FAIL");
+    test_done = true;
+  }
+}
+
+#else  // make sure the example can run for any boards (automated testing)
+void setup() {}
+void loop() {}
+#endif // ADC_USE_DMA
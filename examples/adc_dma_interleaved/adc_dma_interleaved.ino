@@ -0,0 +1,102 @@
+/* Example for sampling one pin at twice the rate with both ADCs
+    Valid for the Teensy 3.x and 4.0 with two ADCs.
+
+  Timers:
+    On Teensy 3.x both ADCs use the PDB, ADC1 with its pretrigger delayed
+    half a period.
+
+    On Teensy 4, ADC1 follows the QuadTimer of ADC0 with half a period of
+    delay in the ADC_ETC.
+
+  DMA: using AnalogBufferDMA in synchronized mode, each ADC has its own DMA
+  channel and they write into the same buffers in turns, so the buffers have
+  the samples in order at twice the rate of each ADC.
+  The gain and offset of ADC1 are matched to ADC0 with
+  ADC_InterleaveCorrection, estimated from the first buffers. The corrected
+  samples are copied to another buffer, the DMA buffers are only read.
+*/
+
+#include <ADC.h>
+#include <ADC_util.h>
+
+#if defined(ADC_USE_DMA) && defined(ADC_DUAL_ADCS) && defined(ADC_USE_TIMER)
+
+#include <ADC_interleave.h>
+#include <AnalogBufferDMA.h>
+
+const int readPin = A2; // valid in both ADCs
+const uint32_t sample_rate = 400000; // Hz, 200 kHz per ADC
+
+ADC *adc = new ADC(); // adc object
+
+const uint32_t buffer_size = 1024; // 512 samples of each ADC
+const uint8_t buffer_num = 4;
+DMAMEM static volatile uint16_t __attribute__((aligned(32)))
+dma_adc_buff[buffer_num][buffer_size];
+volatile uint16_t *const dma_adc_buffers[buffer_num] = {
+    dma_adc_buff[0], dma_adc_buff[1], dma_adc_buff[2], dma_adc_buff[3]};
+AnalogBufferDMA abdma(dma_adc_buffers, buffer_num, buffer_size);
+
+ADC_InterleaveCorrection correction(4095); // 12 bits
+uint16_t corrected_buffer[buffer_size];
+bool corrected = false;
+
+void setup() {
+  Serial.begin(9600);
+  while (!Serial && millis() < 5000)
+    ;
+
+  pinMode(readPin, INPUT_DISABLE);
+
+  // same settings so both ADCs take the same time
+  adc->adc0->setAveraging(1);
+  adc->adc0->setResolution(12);
+  adc->adc0->setConversionSpeed(ADC_CONVERSION_SPEED::HIGH_SPEED);
+  adc->adc0->setSamplingSpeed(ADC_SAMPLING_SPEED::HIGH_SPEED);
+  adc->adc1->setAveraging(1);
+  adc->adc1->setResolution(12);
+  adc->adc1->setConversionSpeed(ADC_CONVERSION_SPEED::HIGH_SPEED);
+  adc->adc1->setSamplingSpeed(ADC_SAMPLING_SPEED::HIGH_SPEED);
+
+  if (!abdma.initSynchronized(adc)) {
+    Serial.print("Error: ");
+    Serial.println(getStringADCError(adc->adc0->fail_flag));
+  }
+
+  if (!adc->startInterleaved(readPin, sample_rate)) {
+    Serial.print("Error: ");
+    Serial.println(getStringADCError(adc->adc1->fail_flag));
+  }
+
+  Serial.println("End Setup");
+}
+
+void loop() {
+  volatile uint16_t *pbuffer;
+  while ((pbuffer = abdma.acquireBuffer()) != nullptr) {
+    uint16_t count = abdma.bufferCountAcquired();
+    if (!corrected) {
+      // about 8000 samples of each ADC for the estimate
+      correction.accumulate(pbuffer, count);
+      if (correction.estimate(8000)) {
+        corrected = true;
+        Serial.printf("ADC1 gain %.5f, offset %.2f\n", correction.gain(),
+                      correction.offset());
+      }
+    }
+    correction.correct(pbuffer, corrected_buffer, count);
+    abdma.releaseBuffer();
+
+    // the samples are in order at sample_rate
+    uint32_t sum = 0;
+    for (uint16_t i = 0; i < count; i++) {
+      sum += corrected_buffer[i];
+    }
+    Serial.printf("average: %u\n", sum / count);
+  }
+}
+
+#else  // make sure the example can run for any boards (automated testing)
+void setup() {}
+void loop() {}
+#endif // ADC_USE_DMA and ADC_DUAL_ADCS and ADC_USE_TIMER
@@ -0,0 +1,79 @@
+/* Example for reading the samples of a DMA buffer before it's full
+    Valid for the current Teensy 3.x and 4.0.
+
+  Timers:
+    On Teensy 3.x this uses the PDB timer.
+
+    On Teensy 4, this uses one of the unused QTimers.
+
+  DMA: using AnalogBufferDMA with two big buffers at a low rate, each one
+  takes 10 seconds to fill. Instead of waiting for them, the loop peeks at
+  the buffer being filled every 100 ms and prints the newest samples.
+*/
+
+#include <ADC.h>
+
+#if defined(ADC_USE_DMA) && defined(ADC_USE_TIMER)
+
+#include <AnalogBufferDMA.h>
+#include <DMAChannel.h>
+
+const int readPin_adc_0 = A0;
+
+ADC *adc = new ADC(); // adc object
+
+const uint32_t buffer_size = 1024;
+DMAMEM static volatile uint16_t __attribute__((aligned(32)))
+dma_adc_buff1[buffer_size];
+DMAMEM static volatile uint16_t __attribute__((aligned(32)))
+dma_adc_buff2[buffer_size];
+AnalogBufferDMA abdma(dma_adc_buff1, buffer_size, dma_adc_buff2, buffer_size);
+
+uint16_t printed = 0; // samples of the current buffer already printed
+volatile uint16_t *printed_buffer = nullptr;
+
+elapsedMillis elapsed_since_peek;
+
+void setup() {
+  Serial.begin(9600);
+  while (!Serial && millis() < 5000)
+    ;
+
+  pinMode(readPin_adc_0, INPUT_DISABLE);
+
+  adc->adc0->setAveraging(4);   // set number of averages
+  adc->adc0->setResolution(12); // set bits of resolution
+
+  abdma.init(adc, ADC_0);
+
+  adc->adc0->startSingleRead(readPin_adc_0); // call this to setup everything
+                                             // before the Timer starts
+  adc->adc0->startTimer(100);                // frequency in Hz
+
+  Serial.println("End Setup");
+}
+
+void loop() {
+  if (elapsed_since_peek < 100) {
+    return;
+  }
+  elapsed_since_peek = 0;
+
+  uint16_t count;
+  volatile uint16_t *pbuffer = abdma.peek(&count);
+  if (pbuffer != printed_buffer) {
+    // the DMA moved on to the other buffer
+    printed_buffer = pbuffer;
+    printed = 0;
+  }
+  for (; printed < count; printed++) {
+    Serial.printf("%u ", pbuffer[printed]);
+  }
+  Serial.printf("(%u/%u samples in buffer %u)\n", count, buffer_size,
+                abdma.interruptCount());
+}
+
+#else  // make sure the example can run for any boards (automated testing)
+void setup() {}
+void loop() {}
+#endif // ADC_USE_TIMER and DMA
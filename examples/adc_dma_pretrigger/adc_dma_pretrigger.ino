@@ -0,0 +1,82 @@
+/* Example for an oscilloscope-like capture with pre-trigger samples
+    Valid for the current Teensy 3.x, LC and 4.0.
+
+  DMA: AnalogBufferDMA runs a ring of buffers continuously and tests each
+  filled buffer for a rising edge through the middle of the range. When it's
+  found, it keeps going for post_samples more samples and stops the DMA.
+  The window of pre_samples before and post_samples after the trigger is then
+  read directly from the ring, in segments, and printed.
+  Send any character to arm the trigger again.
+*/
+
+#include <ADC.h>
+
+#ifdef ADC_USE_DMA
+
+#include <AnalogBufferDMA.h>
+
+const int readPin_adc_0 = A0;
+
+ADC *adc = new ADC(); // adc object
+
+#ifdef KINETISL
+const uint32_t buffer_size = 128;
+#else
+const uint32_t buffer_size = 512;
+#endif
+const uint8_t buffer_num = 4;
+DMAMEM static volatile uint16_t __attribute__((aligned(32)))
+dma_adc_buff[buffer_num][buffer_size];
+volatile uint16_t *const dma_adc_buffers[buffer_num] = {
+    dma_adc_buff[0], dma_adc_buff[1], dma_adc_buff[2], dma_adc_buff[3]};
+AnalogBufferDMA abdma(dma_adc_buffers, buffer_num, buffer_size);
+
+const uint32_t pre_samples = buffer_size;
+const uint32_t post_samples = buffer_size;
+
+void setup() {
+  Serial.begin(9600);
+  while (!Serial && millis() < 5000)
+    ;
+
+  pinMode(readPin_adc_0, INPUT_DISABLE);
+
+  adc->adc0->setAveraging(4);   // set number of averages
+  adc->adc0->setResolution(12); // set bits of resolution
+
+  abdma.init(adc, ADC_0);
+  abdma.armTrigger(ADC_DMA_TRIGGER::RISING, adc->adc0->getMaxValue() / 2,
+                   pre_samples, post_samples);
+
+  adc->adc0->startContinuous(readPin_adc_0);
+
+  Serial.println("End Setup");
+}
+
+void loop() {
+  if (abdma.triggerComplete()) {
+    Serial.printf("Triggered at sample %u, %u samples before it:\n",
+                  (uint32_t)abdma.triggerSample(), abdma.triggerPreSamples());
+    volatile uint16_t *segment;
+    uint16_t count;
+    for (uint8_t i = 0; (segment = abdma.triggerWindowSegment(i, &count)); i++) {
+      for (uint16_t j = 0; j < count; j++) {
+        Serial.println(segment[j]);
+      }
+    }
+    abdma.disarmTrigger();
+  }
+
+  if (Serial.available()) {
+    while (Serial.available()) {
+      Serial.read();
+    }
+    abdma.armTrigger(ADC_DMA_TRIGGER::RISING, adc->adc0->getMaxValue() / 2,
+                     pre_samples, post_samples);
+  }
+}
+
+#else  // make sure the example can run for any boards (automated testing)
+void setup() {}
+void loop() {}
+#endif // ADC_USE_DMA
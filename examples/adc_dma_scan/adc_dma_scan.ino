@@ -0,0 +1,77 @@
+/* Example for scanning several pins with one ADC using DMA
+    Valid for the current Teensy 3.x and 4.0.
+
+  DMA: using AnalogBufferDMA in scan mode, a second DMA channel selects the
+  next pin after each conversion, so the buffers contain the pins interleaved
+  without any interrupt per sample. This example uses continuous conversions,
+  a PDB timer on Teensy 3.x works too.
+  The average of each pin is printed every time a buffer is full.
+*/
+
+#include <ADC.h>
+#include <ADC_util.h>
+
+#if defined(ADC_USE_DMA) && !defined(KINETISL)
+
+#include <AnalogBufferDMA.h>
+
+const uint8_t scan_pins[] = {A0, A1, A2, A3};
+const uint8_t scan_num = sizeof(scan_pins);
+
+ADC *adc = new ADC(); // adc object
+
+// multiple of the number of pins and at most 511 samples
+const uint32_t buffer_size = 128 * scan_num;
+DMAMEM static volatile uint16_t __attribute__((aligned(32)))
+dma_adc_buff1[buffer_size];
+DMAMEM static volatile uint16_t __attribute__((aligned(32)))
+dma_adc_buff2[buffer_size];
+AnalogBufferDMA abdma(dma_adc_buff1, buffer_size, dma_adc_buff2, buffer_size);
+
+void setup() {
+  Serial.begin(9600);
+  while (!Serial && millis() < 5000)
+    ;
+
+  for (uint8_t i = 0; i < scan_num; i++) {
+    pinMode(scan_pins[i], INPUT_DISABLE);
+  }
+
+  adc->adc0->setAveraging(4);   // set number of averages
+  adc->adc0->setResolution(12); // set bits of resolution
+  adc->adc0->setConversionSpeed(ADC_CONVERSION_SPEED::MED_SPEED);
+  adc->adc0->setSamplingSpeed(ADC_SAMPLING_SPEED::MED_SPEED);
+
+  abdma.scanMode(scan_pins, scan_num);
+  if (!abdma.init(adc, ADC_0)) {
+    Serial.print("Error: ");
+    Serial.println(getStringADCError(adc->adc0->fail_flag));
+  }
+
+  // Start with the first pin, the DMA selects the next ones
+  adc->adc0->startContinuous(scan_pins[0]);
+
+  Serial.println("End Setup");
+}
+
+void loop() {
+  volatile uint16_t *pbuffer;
+  while ((pbuffer = abdma.acquireBuffer()) != nullptr) {
+    uint16_t count = abdma.bufferCountAcquired();
+    uint32_t sum_values[scan_num] = {0};
+    for (uint16_t i = 0; i < count; i++) {
+      sum_values[i % scan_num] += pbuffer[i];
+    }
+    abdma.releaseBuffer();
+
+    for (uint8_t pin = 0; pin < scan_num; pin++) {
+      Serial.printf("A%u: %u ", pin, sum_values[pin] / (count / scan_num));
+    }
+    Serial.println();
+  }
+}
+
+#else  // make sure the example can run for any boards (automated testing)
+void setup() {}
+void loop() {}
+#endif // ADC_USE_DMA
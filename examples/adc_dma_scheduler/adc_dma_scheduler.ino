@@ -0,0 +1,135 @@
+/* Example for sampling several pins at different rates with one ADC
+    Valid for the Teensy 3.x.
+
+  Timers:
+    The PDB runs at a multiple of all the rates, one conversion per tick.
+
+  DMA: using AnalogBufferDMA in scan mode with the table of pins of an
+  ADC_Scheduler. A second DMA channel selects the pin of the next slot after
+  each conversion. The loop sorts the samples of each buffer into a ring
+  buffer per channel, then adds them up. It prints how many samples each
+  channel got and their average every second.
+  Here a vibration sensor at 50 kHz, a motor current at 20 kHz and a
+  temperature at 10 Hz: the timer runs at 200 kHz with a table of 20 pins.
+  The plan can be checked on a computer with extras/adc_scheduler.
+*/
+
+#include <ADC.h>
+#include <ADC_util.h>
+
+#if defined(ADC_USE_DMA) && defined(ADC_USE_PDB)
+
+#include <ADC_scheduler.h>
+#include <AnalogBufferDMA.h>
+
+ADC *adc = new ADC(); // adc object
+
+const uint8_t temperature_pin = A0;
+const uint8_t current_pin = A1;
+const uint8_t vibration_pin = A2;
+
+ADC_Scheduler scheduler;
+const uint16_t ring_size = 1024;
+uint16_t temperature_ring[16];
+uint16_t current_ring[ring_size];
+uint16_t vibration_ring[ring_size];
+int8_t temperature, current, vibration; // channels
+uint32_t sums[3], counts[3];
+
+// multiple of the table and at most 511 samples
+const uint32_t buffer_size = 500;
+DMAMEM static volatile uint16_t __attribute__((aligned(32)))
+dma_adc_buff1[buffer_size];
+DMAMEM static volatile uint16_t __attribute__((aligned(32)))
+dma_adc_buff2[buffer_size];
+AnalogBufferDMA abdma(dma_adc_buff1, buffer_size, dma_adc_buff2, buffer_size);
+
+elapsedMillis elapsed_since_print;
+
+void setup() {
+  Serial.begin(9600);
+  while (!Serial && millis() < 5000)
+    ;
+
+  temperature = scheduler.addChannel(temperature_pin, 10, temperature_ring,
+                                     sizeof(temperature_ring) / 2);
+  current = scheduler.addChannel(current_pin, 20000, current_ring, ring_size);
+  vibration =
+      scheduler.addChannel(vibration_pin, 50000, vibration_ring, ring_size);
+  if (!scheduler.build(400000) || (buffer_size % scheduler.slotNum())) {
+    Serial.println("No plan for these rates");
+    return;
+  }
+  Serial.printf("Timer %u Hz, %u slots\n", scheduler.timerFrequency(),
+                scheduler.slotNum());
+
+  pinMode(temperature_pin, INPUT_DISABLE);
+  pinMode(current_pin, INPUT_DISABLE);
+  pinMode(vibration_pin, INPUT_DISABLE);
+
+  // fast enough for 200 kHz
+  adc->adc0->setAveraging(1);   // set number of averages
+  adc->adc0->setResolution(12); // set bits of resolution
+  adc->adc0->setConversionSpeed(ADC_CONVERSION_SPEED::HIGH_SPEED);
+  adc->adc0->setSamplingSpeed(ADC_SAMPLING_SPEED::HIGH_SPEED);
+
+  abdma.scanMode(scheduler.slotPins(), scheduler.slotNum());
+  if (!abdma.init(adc, ADC_0)) {
+    Serial.print("Error: ");
+    Serial.println(getStringADCError(adc->adc0->fail_flag));
+    return;
+  }
+
+  // Start with the first slot, the DMA selects the next ones
+  adc->adc0->startSingleRead(scheduler.slotPins()[0]);
+  adc->adc0->startTimer(scheduler.timerFrequency());
+}
+
+// add up the new samples of the channel
+void accumulate(int8_t channel) {
+  uint16_t samples[64];
+  uint16_t n;
+  while ((n = scheduler.read(channel, samples, 64)) > 0) {
+    for (uint16_t i = 0; i < n; i++) {
+      sums[channel] += samples[i];
+    }
+    counts[channel] += n;
+  }
+}
+
+void printChannel(const char *name, int8_t channel) {
+  Serial.printf("%s: %u (%u samples), ", name,
+                counts[channel] ? sums[channel] / counts[channel] : 0,
+                counts[channel]);
+  sums[channel] = counts[channel] = 0;
+}
+
+void loop() {
+  volatile uint16_t *pbuffer;
+  while ((pbuffer = abdma.acquireBuffer()) != nullptr) {
+    // the index of the first sample keeps the channels in place even if a
+    // buffer was lost
+    scheduler.demux(pbuffer, abdma.bufferCountAcquired(),
+                    abdma.bufferFirstSampleAcquired());
+    abdma.releaseBuffer();
+  }
+  for (int8_t channel = 0; channel < scheduler.channelNum(); channel++) {
+    accumulate(channel);
+  }
+
+  if (elapsed_since_print > 1000) {
+    printChannel("temperature", temperature);
+    printChannel("current", current);
+    printChannel("vibration", vibration);
+    Serial.printf("dropped %u samples\n",
+                  scheduler.droppedSamples(current) +
+                      scheduler.droppedSamples(vibration) +
+                      abdma.droppedSamples());
+    elapsed_since_print = 0;
+  }
+}
+
+#else  // make sure the example can run for any boards (automated testing)
+void setup() {}
+void loop() {}
+#endif // ADC_USE_DMA and ADC_USE_PDB
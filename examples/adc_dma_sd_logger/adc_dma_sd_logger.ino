@@ -0,0 +1,139 @@
+/* Example for logging the DMA buffers to the SD card without losing samples
+    Valid for the Teensy 3.5, 3.6 and 4.1 (with the built in SD card).
+
+  Timers:
+    On Teensy 3.x this uses the PDB timer.
+
+    On Teensy 4, this uses one of the unused QTimers.
+
+  DMA: using AnalogBufferDMA with a ring of buffers. The callback copies each
+  filled buffer into the queue of an ADC_SectorLogger from the DMA ISR, and
+  the loop writes the full sectors of the queue to a preallocated contiguous
+  file. The card can stall for a long time now and then, the queue keeps the
+  samples meanwhile. The worst queue depth is printed every second, make the
+  queue bigger if it gets close to the size.
+  The file has the 16 bit samples in little endian.
+*/
+
+#include <ADC.h>
+
+#if defined(ADC_USE_DMA) && defined(ADC_USE_TIMER) && defined(BUILTIN_SDCARD)
+
+#include <ADC_logger.h>
+#include <AnalogBufferDMA.h>
+#include <DMAChannel.h>
+#include <SD.h>
+
+const int readPin_adc_0 = A0;
+const uint32_t sample_rate = 100000; // Hz
+const uint32_t log_seconds = 60;
+
+ADC *adc = new ADC(); // adc object
+
+const uint32_t buffer_size = 512;
+const uint8_t buffer_num = 4;
+DMAMEM static volatile uint16_t __attribute__((aligned(32)))
+dma_adc_buff[buffer_num][buffer_size];
+volatile uint16_t *const dma_adc_buffers[buffer_num] = {
+    dma_adc_buff[0], dma_adc_buff[1], dma_adc_buff[2], dma_adc_buff[3]};
+AnalogBufferDMA abdma(dma_adc_buffers, buffer_num, buffer_size);
+
+FsFile file;
+
+// Whole sectors at sector aligned positions of the file go straight from the
+// queue to the card, the preallocated clusters don't need any FAT updates.
+// The logger writes the sectors in order, so the seek is only needed the
+// first time or if that changes.
+struct FileSectors {
+  bool writeSectors(uint32_t sector, const uint8_t *src, size_t count) {
+    uint64_t position = (uint64_t)sector * 512;
+    if ((file.curPosition() != position) && !file.seekSet(position)) {
+      return false;
+    }
+    return file.write(src, count * 512) == count * 512;
+  }
+} file_sectors;
+
+// 64 kB of queue, about 0.3 s of samples at 100 kHz
+const uint32_t queue_sectors = 128;
+static uint8_t __attribute__((aligned(32))) queue[queue_sectors * 512];
+ADC_SectorLogger<FileSectors> logger(file_sectors, queue, queue_sectors);
+
+void logBuffer(volatile uint16_t *buffer, uint16_t count, uint64_t timestamp,
+               uint32_t sequence) {
+  logger.push(buffer, count);
+}
+
+elapsedMillis elapsed_since_print;
+bool logging = false;
+
+void setup() {
+  Serial.begin(9600);
+  while (!Serial && millis() < 5000)
+    ;
+
+  if (!SD.begin(BUILTIN_SDCARD)) {
+    Serial.println("SD card failed");
+    return;
+  }
+  const uint64_t log_bytes = (uint64_t)sample_rate * log_seconds * 2;
+  file = SD.sdfs.open("adc_log.bin", O_RDWR | O_CREAT | O_TRUNC);
+  if (!file || !file.preAllocate(log_bytes)) {
+    Serial.println("Can't preallocate the file");
+    return;
+  }
+  logger.begin(0, (log_bytes + 511) / 512);
+
+  pinMode(readPin_adc_0, INPUT_DISABLE);
+  adc->adc0->setAveraging(1);   // set number of averages
+  adc->adc0->setResolution(12); // set bits of resolution
+
+  abdma.attachCallback(logBuffer);
+  abdma.init(adc, ADC_0);
+
+  adc->adc0->startSingleRead(readPin_adc_0); // call this to setup everything
+                                             // before the Timer starts
+  adc->adc0->startTimer(sample_rate);        // frequency in Hz
+  logging = true;
+  Serial.println("Logging");
+}
+
+void loop() {
+  if (!logging) {
+    return;
+  }
+
+  if (logger.update() < 0) {
+    Serial.println("SD card write failed");
+    adc->adc0->stopTimer();
+    logging = false;
+    return;
+  }
+
+  if (elapsed_since_print > 1000) {
+    Serial.printf("%u sectors, worst queue depth %u of %u bytes, dropped %u "
+                  "samples (%u in the DMA)\n",
+                  logger.sectorsWritten(), logger.maxQueueDepth(),
+                  logger.queueSize(), logger.droppedSamples(),
+                  abdma.droppedSamples());
+    elapsed_since_print = 0;
+  }
+
+  if (millis() > log_seconds * 1000 + 5000) {
+    adc->adc0->stopTimer();
+    abdma.detachCallback();
+    if (!logger.flush()) {
+      Serial.println("SD card write failed");
+    }
+    // the samples logged, without the zeros that complete the last sector
+    file.truncate(logger.bytesLogged());
+    file.close();
+    logging = false;
+    Serial.println("Done");
+  }
+}
+
+#else  // make sure the example can run for any boards (automated testing)
+void setup() {}
+void loop() {}
+#endif // ADC_USE_TIMER and DMA and BUILTIN_SDCARD
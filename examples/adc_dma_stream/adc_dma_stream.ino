@@ -0,0 +1,63 @@
+/* Example for streaming DMA buffers to the computer in binary
+    Valid for the current Teensy 3.x and 4.0.
+
+  Timers:
+    On Teensy 3.x this uses the PDB timer.
+
+    On Teensy 4, this uses one of the unused QTimers.
+
+  DMA: using AnalogBufferDMA with a ring of buffers, each filled buffer is
+  sent through the USB serial by AnalogBufferDMAStream as a binary frame with
+  its channel ID, sequence number and timestamp, the samples are written
+  directly from the DMA buffer. Nothing else should be printed to Serial.
+
+  Decode it in the computer with the tool in extras/adc_stream:
+    ./adc_stream_decode --csv < /dev/ttyACM0
+*/
+
+#include <ADC.h>
+
+#if defined(ADC_USE_DMA) && defined(ADC_USE_TIMER)
+
+#include <AnalogBufferDMA.h>
+#include <AnalogBufferDMAStream.h>
+#include <DMAChannel.h>
+
+const int readPin_adc_0 = A0;
+
+ADC *adc = new ADC(); // adc object
+
+const uint32_t buffer_size = 1024;
+const uint8_t buffer_num = 4;
+DMAMEM static volatile uint16_t __attribute__((aligned(32)))
+dma_adc_buff[buffer_num][buffer_size];
+volatile uint16_t *const dma_adc_buffers[buffer_num] = {
+    dma_adc_buff[0], dma_adc_buff[1], dma_adc_buff[2], dma_adc_buff[3]};
+AnalogBufferDMA abdma(dma_adc_buffers, buffer_num, buffer_size);
+
+const uint8_t stream_channel = 0; // channel ID in the frames
+AnalogBufferDMAStream stream(abdma, stream_channel, Serial);
+
+void setup() {
+  Serial.begin(9600);
+  while (!Serial)
+    ;
+
+  pinMode(readPin_adc_0, INPUT_DISABLE);
+
+  adc->adc0->setAveraging(1);   // set number of averages
+  adc->adc0->setResolution(12); // set bits of resolution
+
+  abdma.init(adc, ADC_0);
+
+  adc->adc0->startSingleRead(readPin_adc_0); // call this to setup everything
+                                             // before the Timer starts
+  adc->adc0->startTimer(100000);             // frequency in Hz
+}
+
+void loop() { stream.update(); }
+
+#else  // make sure the example can run for any boards (automated testing)
+void setup() {}
+void loop() {}
+#endif // ADC_USE_TIMER and DMA
@@ -0,0 +1,110 @@
+/* Example for switching an ADC between several DMA objects
+    Valid for the current Teensy 3.x and 4.0.
+
+  Timers:
+    On Teensy 3.x this uses the PDB timer.
+
+    On Teensy 4, this uses one of the unused QTimers.
+
+  DMA: two AnalogBufferDMA rings share ADC0, one reads readPin_fast at
+  20 kHz and the other readPin_slow at 1 kHz. Both are prepared once, and
+  every second the loop switches to the other one. The switch happens when
+  the running ring finishes its current buffer, no buffer is left half
+  filled and nothing needs to be initialized again.
+*/
+
+#include <ADC.h>
+#include <ADC_util.h>
+
+#if defined(ADC_USE_DMA) && defined(ADC_USE_TIMER)
+
+#include <AnalogBufferDMA.h>
+#include <DMAChannel.h>
+
+const int readPin_fast = A0;
+const int readPin_slow = A1;
+
+ADC *adc = new ADC(); // adc object
+
+const uint32_t buffer_size = 256;
+const uint8_t buffer_num = 4;
+DMAMEM static volatile uint16_t __attribute__((aligned(32)))
+dma_fast_buff[buffer_num][buffer_size];
+DMAMEM static volatile uint16_t __attribute__((aligned(32)))
+dma_slow_buff[buffer_num][buffer_size];
+volatile uint16_t *const dma_fast_buffers[buffer_num] = {
+    dma_fast_buff[0], dma_fast_buff[1], dma_fast_buff[2], dma_fast_buff[3]};
+volatile uint16_t *const dma_slow_buffers[buffer_num] = {
+    dma_slow_buff[0], dma_slow_buff[1], dma_slow_buff[2], dma_slow_buff[3]};
+AnalogBufferDMA abdma_fast(dma_fast_buffers, buffer_num, buffer_size);
+AnalogBufferDMA abdma_slow(dma_slow_buffers, buffer_num, buffer_size);
+
+elapsedMillis elapsed_since_switch;
+
+void setup() {
+  Serial.begin(9600);
+  while (!Serial && millis() < 5000)
+    ;
+
+  pinMode(readPin_fast, INPUT_DISABLE);
+  pinMode(readPin_slow, INPUT_DISABLE);
+
+  adc->adc0->setAveraging(4);   // set number of averages
+  adc->adc0->setResolution(12); // set bits of resolution
+
+  if (!abdma_fast.prepare(adc, ADC_0, readPin_fast, 20000) ||
+      !abdma_slow.prepare(adc, ADC_0, readPin_slow, 1000)) {
+    Serial.println("Error preparing the DMA");
+    return;
+  }
+
+  adc->adc0->startSingleRead(readPin_fast); // call this to setup everything
+                                            // before the Timer starts
+  adc->adc0->startTimer(20000);             // frequency in Hz
+  abdma_fast.switchTo();
+
+  Serial.println("End Setup");
+  elapsed_since_switch = 0;
+}
+
+void printBuffers(AnalogBufferDMA &abdma, const char *name) {
+  volatile uint16_t *pbuffer;
+  while ((pbuffer = abdma.acquireBuffer()) != nullptr) {
+    uint16_t count = abdma.bufferCountAcquired();
+    uint32_t sum_values = 0;
+    for (uint16_t i = 0; i < count; i++) {
+      sum_values += pbuffer[i];
+    }
+    abdma.releaseBuffer();
+    Serial.printf("%s %u: average %u\n", name, abdma.interruptCount(),
+                  sum_values / count);
+  }
+}
+
+void loop() {
+  printBuffers(abdma_fast, "fast");
+  printBuffers(abdma_slow, "slow");
+
+  if (elapsed_since_switch > 1000) {
+    AnalogBufferDMA &next = abdma_fast.active() ? abdma_slow : abdma_fast;
+    if (next.switchTo()) {
+      Serial.printf("Switching to the %s ring\n",
+                    (&next == &abdma_fast) ? "fast" : "slow");
+    } else {
+      Serial.println("Switch refused");
+    }
+    elapsed_since_switch = 0;
+  }
+
+  // a switch that couldn't start the next ring in the ISR stops the ADC
+  if (adc->adc0->fail_flag != ADC_ERROR::CLEAR) {
+    Serial.print("ADC0: ");
+    Serial.println(getStringADCError(adc->adc0->fail_flag));
+    adc->adc0->resetError();
+  }
+}
+
+#else  // make sure the example can run for any boards (automated testing)
+void setup() {}
+void loop() {}
+#endif // ADC_USE_TIMER and DMA
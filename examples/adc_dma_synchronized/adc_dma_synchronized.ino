@@ -0,0 +1,106 @@
+/* Example for streaming synchronized measurements of both ADCs with DMA
+    Valid for the Teensy 3.x and 4.0 with two ADCs.
+
+  DMA: using AnalogBufferDMA in synchronized mode, each ADC has its own DMA
+  channel and they write into the same buffers as pairs: adc0, adc1, adc0, ...
+  Both ADCs convert at the same time, so each pair is sampled at the same
+  instant. The buffers must be contiguous, here they are the rows of one array.
+  The loop computes the average of each ADC and of their product.
+  It also checks that each buffer is only handed over once both ADCs wrote it:
+  the ADC1 slots are marked with a value no conversion can return before the
+  DMA fills them, a mark left in an acquired buffer is a missing ADC1 result.
+*/
+
+#include <ADC.h>
+#include <ADC_util.h>
+
+#if defined(ADC_USE_DMA) && defined(ADC_DUAL_ADCS)
+
+#include <AnalogBufferDMA.h>
+
+#if defined(ADC_TEENSY_4)
+const int readPin_adc_0 = A0;
+const int readPin_adc_1 = 26;
+#else
+const int readPin_adc_0 = A9;
+const int readPin_adc_1 = A3;
+#endif
+
+ADC *adc = new ADC(); // adc object
+
+const uint32_t buffer_size = 1024; // 512 pairs
+const uint8_t buffer_num = 4;
+DMAMEM static volatile uint16_t __attribute__((aligned(32)))
+dma_adc_buff[buffer_num][buffer_size];
+volatile uint16_t *const dma_adc_buffers[buffer_num] = {
+    dma_adc_buff[0], dma_adc_buff[1], dma_adc_buff[2], dma_adc_buff[3]};
+AnalogBufferDMA abdma(dma_adc_buffers, buffer_num, buffer_size);
+
+const uint16_t not_written = 0xFFFF; // out of range of 12 bit results
+uint32_t missing_adc1 = 0;
+
+// mark the ADC1 slots, and write them to memory before the DMA fills them
+void markADC1(volatile uint16_t *buffer, uint16_t count) {
+  for (uint16_t i = 1; i < count; i += 2) {
+    buffer[i] = not_written;
+  }
+#if defined(ADC_TEENSY_4)
+  arm_dcache_flush_delete((void *)buffer, count * 2);
+#endif
+}
+
+void setup() {
+  Serial.begin(9600);
+  while (!Serial && millis() < 5000)
+    ;
+
+  pinMode(readPin_adc_0, INPUT_DISABLE);
+  pinMode(readPin_adc_1, INPUT_DISABLE);
+
+  // same settings so both ADCs take the same time
+  adc->adc0->setAveraging(4);
+  adc->adc0->setResolution(12);
+  adc->adc1->setAveraging(4);
+  adc->adc1->setResolution(12);
+
+  for (uint8_t i = 0; i < buffer_num; i++) {
+    markADC1(dma_adc_buffers[i], buffer_size);
+  }
+  if (!abdma.initSynchronized(adc)) {
+    Serial.print("Error: ");
+    Serial.println(getStringADCError(adc->adc0->fail_flag));
+  }
+
+  adc->startSynchronizedContinuous(readPin_adc_0, readPin_adc_1);
+
+  Serial.println("End Setup");
+}
+
+void loop() {
+  volatile uint16_t *pbuffer;
+  while ((pbuffer = abdma.acquireBuffer()) != nullptr) {
+    uint16_t count = abdma.bufferCountAcquired();
+    uint32_t sum0 = 0, sum1 = 0;
+    float sum_product = 0;
+    for (uint16_t i = 0; i < count; i += 2) {
+      if (pbuffer[i + 1] == not_written) {
+        missing_adc1++;
+      }
+      sum0 += pbuffer[i];
+      sum1 += pbuffer[i + 1];
+      sum_product += (float)pbuffer[i] * pbuffer[i + 1];
+    }
+    markADC1(pbuffer, count);
+    abdma.releaseBuffer();
+
+    uint16_t pairs = count / 2;
+    Serial.printf("ADC0: %u, ADC1: %u, product: %.0f, ADC1 results missing: %u %s\n",
+                  sum0 / pairs, sum1 / pairs, sum_product / pairs, missing_adc1,
+                  missing_adc1 ? "FAIL" : "PASS");
+  }
+}
+
+#else  // make sure the example can run for any boards (automated testing)
+void setup() {}
+void loop() {}
+#endif // ADC_USE_DMA and ADC_DUAL_ADCS
@@ -94,7 +94,10 @@ void loop() {
       }
     } else if (c == 'p') { // pbd stats
       Serial.print("Frequency: ");
-      Serial.println(adc->adc0->getPDBFrequency());
+      Serial.print(adc->adc0->getPDBExactFrequency(), 3);
+      Serial.print(" Hz, error: ");
+      Serial.print(adc->adc0->getPDBFrequencyError(), 3);
+      Serial.println(" Hz");
     }
   }
 
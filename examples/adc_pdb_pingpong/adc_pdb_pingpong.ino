@@ -0,0 +1,78 @@
+/* Example for converting two pins each PDB period on the same ADC
+    Valid for the Teensy 3.x.
+
+  PDB: pretrigger 0 converts readPinA (SC1A) at the start of each period,
+  pretrigger 1 converts readPinB (SC1B) delay_us later.
+
+  DMA: AnalogBufferDMA in ping-pong mode reads RA and RB in turns, so the
+  buffers contain (readPinA, readPinB) pairs without any CPU work.
+*/
+
+#include <ADC.h>
+#include <ADC_util.h>
+
+#if defined(ADC_USE_DMA) && defined(ADC_USE_PDB)
+
+#include <AnalogBufferDMA.h>
+#include <DMAChannel.h>
+
+// both pins must use the same mux (a or b) of ADC0
+const int readPinA = A0;
+const int readPinB = A1;
+const uint32_t delay_us = 20; // 0 converts readPinB as soon as readPinA is done
+
+ADC *adc = new ADC(); // adc object
+
+const uint32_t buffer_size = 256; // 128 pairs
+static volatile uint16_t __attribute__((aligned(32))) dma_adc_buff1[buffer_size];
+static volatile uint16_t __attribute__((aligned(32))) dma_adc_buff2[buffer_size];
+AnalogBufferDMA abdma(dma_adc_buff1, buffer_size, dma_adc_buff2, buffer_size);
+
+void setup() {
+  Serial.begin(9600);
+  while (!Serial && millis() < 5000)
+    ;
+
+  pinMode(readPinA, INPUT_DISABLE);
+  pinMode(readPinB, INPUT_DISABLE);
+
+  adc->adc0->setAveraging(1);   // set number of averages
+  adc->adc0->setResolution(12); // set bits of resolution
+  adc->adc0->setConversionSpeed(ADC_CONVERSION_SPEED::HIGH_SPEED);
+  adc->adc0->setSamplingSpeed(ADC_SAMPLING_SPEED::HIGH_SPEED);
+
+  abdma.pingPongMode(true);
+  if (!abdma.init(adc, ADC_0)) {
+    Serial.println("DMA init failed");
+  }
+
+  adc->adc0->startSingleRead(readPinA); // call this to setup everything
+                                        // before the PDB starts
+  if (!adc->adc0->startPDBPingPong(readPinA, readPinB, 10000, delay_us)) {
+    Serial.print("Error: ");
+    Serial.println(getStringADCError(adc->adc0->fail_flag));
+  }
+
+  Serial.println("End Setup");
+}
+
+void loop() {
+  volatile uint16_t *pbuffer;
+  while ((pbuffer = abdma.acquireBuffer()) != nullptr) {
+    uint16_t count = abdma.bufferCountAcquired();
+    uint32_t sum_a = 0;
+    uint32_t sum_b = 0;
+    for (uint16_t i = 0; i < count; i += 2) {
+      sum_a += pbuffer[i];
+      sum_b += pbuffer[i + 1];
+    }
+    abdma.releaseBuffer();
+    Serial.printf("%u: pin A %u, pin B %u\n", abdma.interruptCount(),
+                  sum_a / (count / 2), sum_b / (count / 2));
+  }
+}
+
+#else  // make sure the example can run for any boards (automated testing)
+void setup() {}
+void loop() {}
+#endif // ADC_USE_PDB and DMA
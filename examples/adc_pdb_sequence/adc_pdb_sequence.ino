@@ -0,0 +1,103 @@
+/* Example for converting four pins of both ADCs at fixed times each PDB period
+    Valid for the Teensy 3.1, 3.2, 3.5 and 3.6 (two ADCs with a PDB).
+
+  PDB: the sequence has two steps per ADC. At the start of each period ADC0
+  converts the voltage and ADC1 the current of line 1 at the same time.
+  delay_ns later they convert the voltage and current of line 2. The delays
+  are in the PDB registers, so the timing doesn't depend on the CPU.
+  128 samples per 60 Hz cycle.
+
+  DMA: one AnalogBufferDMA per ADC in ping-pong mode reads RA and RB in turns.
+  The buffers of ADC0 have (voltage 1, voltage 2) pairs and the ones of ADC1
+  (current 1, current 2). The average of voltage * current of each line
+  (raw values, around mid scale) is printed for each buffer.
+*/
+
+#include <ADC.h>
+#include <ADC_util.h>
+
+#if defined(ADC_USE_DMA) && defined(ADC_USE_PDB) && defined(ADC_DUAL_ADCS)
+
+#include <AnalogBufferDMA.h>
+
+// both pins of each ADC must use the same mux (a or b)
+const uint8_t voltage1_pin = A0; // ADC0
+const uint8_t voltage2_pin = A1; // ADC0
+const uint8_t current1_pin = A2; // ADC1
+const uint8_t current2_pin = A3; // ADC1
+const uint32_t delay_ns = 20000;
+const uint32_t sample_rate = 60 * 128; // Hz
+
+ADC *adc = new ADC(); // adc object
+ADC_pdb::Sequence sequence;
+
+const uint32_t buffer_size = 256; // 128 pairs, a 60 Hz cycle
+static volatile uint16_t __attribute__((aligned(32))) voltage_buff1[buffer_size];
+static volatile uint16_t __attribute__((aligned(32))) voltage_buff2[buffer_size];
+static volatile uint16_t __attribute__((aligned(32))) current_buff1[buffer_size];
+static volatile uint16_t __attribute__((aligned(32))) current_buff2[buffer_size];
+AnalogBufferDMA abdma0(voltage_buff1, buffer_size, voltage_buff2, buffer_size);
+AnalogBufferDMA abdma1(current_buff1, buffer_size, current_buff2, buffer_size);
+
+void setup() {
+  Serial.begin(9600);
+  while (!Serial && millis() < 5000)
+    ;
+
+  pinMode(voltage1_pin, INPUT_DISABLE);
+  pinMode(voltage2_pin, INPUT_DISABLE);
+  pinMode(current1_pin, INPUT_DISABLE);
+  pinMode(current2_pin, INPUT_DISABLE);
+
+  for (ADC_Module *adc_module : adc->adc) {
+    adc_module->setAveraging(1);   // set number of averages
+    adc_module->setResolution(12); // set bits of resolution
+    adc_module->setConversionSpeed(ADC_CONVERSION_SPEED::HIGH_SPEED);
+    adc_module->setSamplingSpeed(ADC_SAMPLING_SPEED::HIGH_SPEED);
+  }
+
+  // adc, pretrigger (0: SC1A, 1: SC1B), pin, delay from the start
+  sequence.add(0, 0, voltage1_pin, 0);
+  sequence.add(1, 0, current1_pin, 0);
+  sequence.add(0, 1, voltage2_pin, delay_ns);
+  sequence.add(1, 1, current2_pin, delay_ns);
+
+  abdma0.pingPongMode(true);
+  abdma1.pingPongMode(true);
+  if (!abdma0.init(adc, ADC_0) || !abdma1.init(adc, ADC_1)) {
+    Serial.println("DMA init failed");
+  }
+
+  if (!adc->startPDBSequence(sequence, sample_rate)) {
+    Serial.print("Error: ");
+    Serial.print(getStringADCError(adc->adc0->fail_flag));
+    Serial.println(getStringADCError(adc->adc1->fail_flag));
+  }
+
+  Serial.println("End Setup");
+}
+
+void loop() {
+  // both ADCs fill their buffers with the same triggers
+  if (!abdma0.buffersAvailable() || !abdma1.buffersAvailable()) {
+    return;
+  }
+  volatile uint16_t *voltage = abdma0.acquireBuffer();
+  volatile uint16_t *current = abdma1.acquireBuffer();
+  const uint16_t count = abdma0.bufferCountAcquired();
+  int32_t power1 = 0, power2 = 0;
+  for (uint16_t i = 0; i < count; i += 2) {
+    power1 += ((int32_t)voltage[i] - 2048) * ((int32_t)current[i] - 2048) / 64;
+    power2 += ((int32_t)voltage[i + 1] - 2048) *
+              ((int32_t)current[i + 1] - 2048) / 64;
+  }
+  abdma0.releaseBuffer();
+  abdma1.releaseBuffer();
+  Serial.printf("line 1: %d, line 2: %d\n", power1 / (count / 2) * 64,
+                power2 / (count / 2) * 64);
+}
+
+#else  // make sure the example can run for any boards (automated testing)
+void setup() {}
+void loop() {}
+#endif // ADC_USE_PDB, two ADCs and DMA
@@ -0,0 +1,80 @@
+/* Example for running both ADCs at unrelated, exactly known rates
+    Valid for the Teensy 4.
+
+  Timers:
+    Each ADC has its own QuadTimer channel. ADC0 samples at 44.1 kHz, the
+    closest the timer gets is printed with the error. ADC1 samples once every
+    2 seconds (0.5 Hz), which needs a second timer channel in cascade.
+*/
+
+#include <ADC.h>
+
+#if defined(ADC_TEENSY_4)
+
+const int readPin_adc_0 = A0;
+const int readPin_adc_1 = A2;
+
+ADC *adc = new ADC(); // adc object
+
+volatile uint32_t adc0_count = 0;
+
+void adc0_isr() {
+  adc->adc0->readSingle();
+  adc0_count++;
+}
+
+void adc1_isr() {
+  Serial.printf("ADC1: %d\n", adc->adc1->readSingle());
+}
+
+void printRate(ADC_Module *adc_module, const char *name) {
+  Serial.printf("%s: %.6f Hz (error %.6f Hz)\n", name,
+                adc_module->getQuadTimerExactFrequency(),
+                adc_module->getQuadTimerFrequencyError());
+}
+
+void setup() {
+  Serial.begin(9600);
+  while (!Serial && millis() < 5000)
+    ;
+
+  pinMode(readPin_adc_0, INPUT_DISABLE);
+  pinMode(readPin_adc_1, INPUT_DISABLE);
+
+  adc->adc0->setAveraging(1);
+  adc->adc0->setResolution(12);
+  adc->adc0->enableInterrupts(adc0_isr);
+  adc->adc0->startSingleRead(readPin_adc_0);
+  if (!adc->adc0->startQuadTimer(44100)) {
+    Serial.println("ADC0 frequency out of range");
+  }
+
+  adc->adc1->setAveraging(16);
+  adc->adc1->setResolution(12);
+  adc->adc1->enableInterrupts(adc1_isr);
+  adc->adc1->startSingleRead(readPin_adc_1);
+  if (!adc->adc1->startQuadTimer(0.5)) {
+    Serial.println("ADC1 frequency out of range");
+  }
+
+  printRate(adc->adc0, "ADC0");
+  printRate(adc->adc1, "ADC1");
+}
+
+elapsedMillis elapsed;
+
+void loop() {
+  if (elapsed >= 10000) {
+    elapsed = 0;
+    __disable_irq();
+    uint32_t count = adc0_count;
+    adc0_count = 0;
+    __enable_irq();
+    Serial.printf("ADC0: %u conversions in 10 s\n", count);
+  }
+}
+
+#else  // make sure the example can run for any boards (automated testing)
+void setup() {}
+void loop() {}
+#endif // ADC_TEENSY_4
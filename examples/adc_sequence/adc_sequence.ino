@@ -0,0 +1,55 @@
+/* Example for reading several pins with a hardware sequence
+    Valid for the Teensy 4.
+
+  The pins are loaded once with setSequence, then each analogReadSequence
+  converts all of them back to back with a single register write and copies
+  the results. Compare the time with a loop of analogRead calls.
+*/
+
+#include <ADC.h>
+
+#if defined(ADC_TEENSY_4)
+
+const uint8_t pin_num = 4;
+const uint8_t pins[pin_num] = {A0, A1, A2, A3};
+
+ADC *adc = new ADC(); // adc object
+
+int values[pin_num];
+
+void setup() {
+  Serial.begin(9600);
+  while (!Serial && millis() < 5000)
+    ;
+
+  for (uint8_t i = 0; i < pin_num; i++) {
+    pinMode(pins[i], INPUT_DISABLE);
+  }
+
+  adc->adc0->setAveraging(1);   // set number of averages
+  adc->adc0->setResolution(12); // set bits of resolution
+
+  if (!adc->adc0->setSequence(pins, pin_num)) {
+    Serial.println("Wrong pins");
+  }
+
+  Serial.println("End Setup");
+}
+
+void loop() {
+  elapsedMicros time;
+  adc->adc0->analogReadSequence(values);
+  uint32_t sequence_time = time;
+
+  for (uint8_t i = 0; i < pin_num; i++) {
+    Serial.printf("A%u: %d ", i, values[i]);
+  }
+  Serial.printf("(%u us)\n", sequence_time);
+
+  delay(500);
+}
+
+#else  // make sure the example can run for any boards (automated testing)
+void setup() {}
+void loop() {}
+#endif // ADC_TEENSY_4
@@ -159,8 +159,6 @@ void ProcessAnalogData(AnalogBufferDMA *pabdma, int8_t adc_num) {
   volatile uint16_t *end_pbuffer = pbuffer + pabdma->bufferCountLastISRFilled();
 
   float sum_delta_sq = 0.0;
-  if ((uint32_t)pbuffer >= 0x20200000u)
-    arm_dcache_delete((void *)pbuffer, sizeof(dma_adc_buff1));
   while (pbuffer < end_pbuffer) {
     if (*pbuffer < min_val)
       min_val = *pbuffer;
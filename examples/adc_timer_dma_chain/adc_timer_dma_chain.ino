@@ -0,0 +1,76 @@
+/* Example for sampling several pins each timer period with DMA
+    Valid for the Teensy 4.
+
+  Timers:
+    One of the unused QTimers triggers a chain of conversions in the ADC_ETC,
+    the pins are converted back to back each period.
+
+  DMA: using AnalogBufferDMA in chain mode, each period the DMA copies the
+  results of the whole chain, so the buffers have the pins interleaved:
+  A0, A1, A2, A3, A0, A1, ...
+*/
+
+#include <ADC.h>
+
+#if defined(ADC_USE_DMA) && defined(ADC_TEENSY_4)
+
+#include <AnalogBufferDMA.h>
+#include <DMAChannel.h>
+
+const uint8_t pin_num = 4;
+const uint8_t pins[pin_num] = {A0, A1, A2, A3};
+
+ADC *adc = new ADC(); // adc object
+
+// multiples of pin_num
+const uint32_t buffer_size = 1600;
+DMAMEM static volatile uint16_t __attribute__((aligned(32)))
+dma_adc_buff1[buffer_size];
+DMAMEM static volatile uint16_t __attribute__((aligned(32)))
+dma_adc_buff2[buffer_size];
+AnalogBufferDMA abdma(dma_adc_buff1, buffer_size, dma_adc_buff2, buffer_size);
+
+void setup() {
+  Serial.begin(9600);
+  while (!Serial && millis() < 5000)
+    ;
+
+  for (uint8_t i = 0; i < pin_num; i++) {
+    pinMode(pins[i], INPUT_DISABLE);
+  }
+
+  adc->adc0->setAveraging(1);   // set number of averages
+  adc->adc0->setResolution(12); // set bits of resolution
+
+  abdma.chainMode(pin_num);
+  abdma.init(adc, ADC_0); // before the chain, it enables the ADC_ETC DMA
+
+  // 10 kHz per pin
+  if (!adc->adc0->startQuadTimerChain(pins, pin_num, 10000)) {
+    Serial.println("Wrong pins");
+  }
+
+  Serial.println("End Setup");
+}
+
+void loop() {
+  if (abdma.interrupted()) {
+    volatile uint16_t *pbuffer = abdma.bufferLastISRFilled();
+    uint16_t count = abdma.bufferCountLastISRFilled();
+    // average of each pin
+    uint32_t sums[pin_num] = {0};
+    for (uint16_t i = 0; i < count; i++) {
+      sums[i % pin_num] += pbuffer[i];
+    }
+    for (uint8_t i = 0; i < pin_num; i++) {
+      Serial.printf("A%u: %u ", i, sums[i] / (count / pin_num));
+    }
+    Serial.println();
+    abdma.clearInterrupt();
+  }
+}
+
+#else  // make sure the example can run for any boards (automated testing)
+void setup() {}
+void loop() {}
+#endif // ADC_TEENSY_4 and DMA
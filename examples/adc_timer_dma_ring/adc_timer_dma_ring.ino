@@ -0,0 +1,106 @@
+/* Example for triggering the ADC with Timer using a ring of DMA buffers
+    Valid for the current Teensy 3.x and 4.0.
+
+  Timers:
+    On Teensy 3.x this uses the PDB timer.
+
+    On Teensy 4, this uses one of the unused QTimers.
+
+  DMA: using AnalogBufferDMA with a ring of buffer_num buffers, the DMA fills
+  them in order continuously. The loop acquires the oldest filled buffer,
+  processes it and releases it, so it can fall behind by up to buffer_num - 1
+  buffers without losing any samples. If it falls further behind, the
+  dropped buffers and samples are reported.
+  To show this, the loop is slowed down every now and then.
+*/
+
+#include <ADC.h>
+
+#if defined(ADC_USE_DMA) && defined(ADC_USE_TIMER)
+
+#include <AnalogBufferDMA.h>
+#include <DMAChannel.h>
+
+const int readPin_adc_0 = A0;
+
+ADC *adc = new ADC(); // adc object
+
+const uint32_t buffer_size = 512;
+const uint8_t buffer_num = 6;
+DMAMEM static volatile uint16_t __attribute__((aligned(32)))
+dma_adc_buff[buffer_num][buffer_size];
+volatile uint16_t *const dma_adc_buffers[buffer_num] = {
+    dma_adc_buff[0], dma_adc_buff[1], dma_adc_buff[2],
+    dma_adc_buff[3], dma_adc_buff[4], dma_adc_buff[5]};
+AnalogBufferDMA abdma(dma_adc_buffers, buffer_num, buffer_size);
+
+elapsedMillis elapsed_sinc_last_display;
+
+void setup() {
+  Serial.begin(9600);
+  while (!Serial && millis() < 5000)
+    ;
+
+  pinMode(readPin_adc_0, INPUT_DISABLE);
+
+  adc->adc0->setAveraging(4);   // set number of averages
+  adc->adc0->setResolution(12); // set bits of resolution
+
+  abdma.init(adc, ADC_0);
+
+  adc->adc0->startSingleRead(readPin_adc_0); // call this to setup everything
+                                             // before the Timer starts
+  adc->adc0->startTimer(20000);              // frequency in Hz
+
+  Serial.println("End Setup");
+  elapsed_sinc_last_display = 0;
+}
+
+void loop() {
+  volatile uint16_t *pbuffer;
+  while ((pbuffer = abdma.acquireBuffer()) != nullptr) {
+    uint16_t count = abdma.bufferCountAcquired();
+    uint32_t sum_values = 0;
+    uint16_t min_val = 0xffff;
+    uint16_t max_val = 0;
+    for (uint16_t i = 0; i < count; i++) {
+      uint16_t value = pbuffer[i];
+      if (value < min_val)
+        min_val = value;
+      if (value > max_val)
+        max_val = value;
+      sum_values += value;
+    }
+    uint8_t pending = abdma.buffersAvailable();
+    uint32_t first_sample = abdma.bufferFirstSampleAcquired();
+    uint32_t time_us = abdma.bufferTimestampAcquired() /
+                       (abdma.timestampFrequency() / 1000000);
+    abdma.releaseBuffer();
+
+    Serial.printf("%u (%u pending) sample %u at %u us: %u <= %u <= %u\n",
+                  abdma.interruptCount(), pending, first_sample, time_us,
+                  min_val, sum_values / count, max_val);
+    elapsed_sinc_last_display = 0;
+  }
+
+  // simulate a slow consumer, the ring absorbs it
+  if ((millis() % 1000) < 10) {
+    delay(60);
+  }
+
+  if (abdma.overrun()) {
+    Serial.printf("Overrun! dropped %u buffers (%u samples)\n",
+                  abdma.droppedBuffers(), abdma.droppedSamples());
+    abdma.resetOverrun();
+  }
+
+  if (elapsed_sinc_last_display > 5000) {
+    Serial.println("No data in 5 seconds");
+    elapsed_sinc_last_display = 0;
+  }
+}
+
+#else  // make sure the example can run for any boards (automated testing)
+void setup() {}
+void loop() {}
+#endif // ADC_USE_TIMER and DMA
@@ -0,0 +1,122 @@
+/* Teensy 4.x, 3.x, LC ADC library
+ * https://github.com/pedvide/ADC
+ * Copyright (c) 2020 Pedro Villanueva
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* Runs ADC_SectorLogger on a computer against a file instead of an SD card.
+ * A thread plays the DMA ISR, pushing buffers of a counter at a fixed rate,
+ * while the main thread writes the queue to the file, which stalls now and
+ * then. At the end the file is truncated to the bytes logged, read back and
+ * checked. See README.md.
+ *
+ * Usage: adc_logger_host file [rate_hz] [seconds] [queue_sectors]
+ *                        [stall_every] [stall_ms]
+ */
+
+#include "../../ADC_logger.h"
+#include "file_block_device.h"
+
+#include <atomic>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <thread>
+#include <vector>
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    fprintf(stderr, "Usage: %s file [rate_hz] [seconds] [queue_sectors] [stall_every] [stall_ms]\n", argv[0]);
+    return 2;
+  }
+  const char *path = argv[1];
+  uint32_t rate = (argc > 2) ? strtoul(argv[2], nullptr, 0) : 100000;
+  uint32_t seconds = (argc > 3) ? strtoul(argv[3], nullptr, 0) : 2;
+  uint32_t queue_sectors = (argc > 4) ? strtoul(argv[4], nullptr, 0) : 128;
+  uint32_t stall_every = (argc > 5) ? strtoul(argv[5], nullptr, 0) : 50;
+  uint32_t stall_ms = (argc > 6) ? strtoul(argv[6], nullptr, 0) : 100;
+
+  const uint32_t buffer_size = 256; // samples per DMA buffer
+  uint64_t total_samples = (uint64_t)rate * seconds;
+  uint32_t file_sectors = (uint32_t)((total_samples * 2 + 511) / 512);
+
+  FileBlockDevice device;
+  if (!device.begin(path, file_sectors)) {
+    perror(path);
+    return 2;
+  }
+  device.simulateStalls(stall_every, stall_ms * 1000);
+
+  std::vector<uint8_t> queue(queue_sectors * 512);
+  ADC_SectorLogger<FileBlockDevice> logger(device, queue.data(), queue_sectors);
+  logger.begin(0, file_sectors);
+
+  // the "DMA ISR": a buffer every buffer_size / rate seconds
+  std::atomic<bool> producing(true);
+  std::thread producer([&]() {
+    uint16_t buffer[buffer_size];
+    uint16_t value = 0;
+    auto period = std::chrono::nanoseconds((uint64_t)buffer_size * 1000000000 / rate);
+    auto next = std::chrono::steady_clock::now();
+    for (uint64_t done = 0; done < total_samples; done += buffer_size) {
+      next += period;
+      std::this_thread::sleep_until(next);
+      uint32_t count = (total_samples - done < buffer_size) ? (uint32_t)(total_samples - done) : buffer_size;
+      for (uint32_t i = 0; i < count; i++) {
+        buffer[i] = value++;
+      }
+      logger.push(buffer, count);
+    }
+    producing = false;
+  });
+
+  // the loop
+  while (producing) {
+    if (logger.update(8) < 0) {
+      fprintf(stderr, "Device error\n");
+      break;
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+  }
+  producer.join();
+  bool flushed = logger.flush() && device.truncate(logger.bytesLogged());
+  device.end();
+
+  // check that the file has the counter without gaps, and nothing after it
+  FILE *file = fopen(path, "rb");
+  uint64_t checked = 0;
+  uint16_t sample;
+  while ((checked < total_samples) && (fread(&sample, 2, 1, file) == 1) && (sample == (uint16_t)checked)) {
+    checked++;
+  }
+  bool extra = fread(&sample, 1, 1, file) == 1;
+  fclose(file);
+  if (!flushed || extra) {
+    printf("%s\n", flushed ? "the file has bytes after the last sample" : "flush failed");
+  }
+
+  printf("%u sectors written, %llu of %llu samples correct, %u dropped\n", logger.sectorsWritten(),
+         (unsigned long long)checked, (unsigned long long)total_samples, logger.droppedSamples());
+  printf("worst queue depth: %u of %u bytes (%.0f%%)\n", logger.maxQueueDepth(), logger.queueSize(),
+         100.0 * logger.maxQueueDepth() / logger.queueSize());
+  return ((checked == total_samples) && !logger.droppedSamples() && flushed && !extra) ? 0 : 1;
+}
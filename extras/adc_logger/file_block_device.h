@@ -0,0 +1,92 @@
+/* Teensy 4.x, 3.x, LC ADC library
+ * https://github.com/pedvide/ADC
+ * Copyright (c) 2020 Pedro Villanueva
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* Stand-in for the SD card on a computer: a block device backed by a file,
+ * to run ADC_SectorLogger (ADC_logger.h) on Linux. It can stall every few
+ * writes, like cards do, to check that the queue absorbs it.
+ */
+
+#ifndef FILE_BLOCK_DEVICE_H
+#define FILE_BLOCK_DEVICE_H
+
+#include <chrono>
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <thread>
+#include <unistd.h>
+
+class FileBlockDevice {
+public:
+  ~FileBlockDevice() { end(); }
+
+  //! Create the file with sector_count sectors (the preallocated file)
+  bool begin(const char *path, uint32_t sector_count) {
+    fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+      return false;
+    }
+    sector_num = sector_count;
+    return ftruncate(fd, (off_t)sector_count * 512) == 0;
+  }
+
+  void end() {
+    if (fd >= 0) {
+      close(fd);
+      fd = -1;
+    }
+  }
+
+  //! Every `every` writes, the write takes stall_us longer
+  void simulateStalls(uint32_t every, uint32_t stall_us) {
+    stall_every = every;
+    stall_time_us = stall_us;
+  }
+
+  bool writeSectors(uint32_t sector, const uint8_t *src, size_t count) {
+    if ((fd < 0) || (sector + count > sector_num)) {
+      return false;
+    }
+    if (stall_every && (++writes % stall_every == 0)) {
+      std::this_thread::sleep_for(std::chrono::microseconds(stall_time_us));
+    }
+    ssize_t bytes = pwrite(fd, src, count * 512, (off_t)sector * 512);
+    return bytes == (ssize_t)(count * 512);
+  }
+
+  uint32_t sectors() const { return sector_num; }
+
+  //! Cut the file to the bytes logged, like FsFile::truncate
+  bool truncate(uint64_t bytes) { return (fd >= 0) && (ftruncate(fd, (off_t)bytes) == 0); }
+
+private:
+  int fd = -1;
+  uint32_t sector_num = 0;
+  uint32_t stall_every = 0;
+  uint32_t stall_time_us = 0;
+  uint32_t writes = 0;
+};
+
+#endif // FILE_BLOCK_DEVICE_H
@@ -0,0 +1,178 @@
+/* Teensy 4.x, 3.x, LC ADC library
+ * https://github.com/pedvide/ADC
+ * Copyright (c) 2020 Pedro Villanueva
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* Builds ADC_Scheduler plans on a computer and checks their timing: the
+ * example of examples/adc_dma_scheduler and many random sets of rates. Each
+ * plan is fed buffers of a tick counter, like the DMA buffers with the
+ * conversion number instead of the value, and every channel must get one
+ * sample every divider ticks from its offset, converted with its pin.
+ * See README.md.
+ *
+ * Usage: adc_scheduler_plan [plans] [seed]
+ */
+
+#include "../../ADC_scheduler.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+static uint16_t ring[ADC_SCHEDULER_MAX_CHANNELS][4096];
+
+static void printPlan(const ADC_Scheduler &plan) {
+  printf("timer %u Hz, %u slots:", plan.timerFrequency(), plan.slotNum());
+  for (uint8_t s = 0; s < plan.slotNum(); s++) {
+    const uint8_t c = plan.slotChannel(s);
+    if (c == ADC_Scheduler::IDLE) {
+      printf(" -");
+    } else {
+      printf(" %u", c);
+    }
+  }
+  printf("\n");
+  for (uint8_t c = 0; c < plan.channelNum(); c++) {
+    printf("  channel %u: offset %u, every %u ticks\n", c, plan.channelOffset(c), plan.channelDivider(c));
+  }
+}
+
+// Feed ticks [0, total) in buffers of varied sizes and check every channel,
+// returns the number of errors
+static uint32_t check(ADC_Scheduler &plan, const uint8_t *pins, uint64_t total, uint32_t buffer_size) {
+  uint32_t errors = 0;
+  const uint8_t L = plan.slotNum();
+  for (uint8_t c = 0; c < plan.channelNum(); c++) {
+    if (pins[c] != plan.slotPins()[plan.channelOffset(c) % L]) {
+      printf("  channel %u: slot %u converts pin %u\n", c, plan.channelOffset(c) % L,
+             plan.slotPins()[plan.channelOffset(c) % L]);
+      errors++;
+    }
+  }
+
+  plan.resetDemux();
+  std::vector<uint16_t> buffer(buffer_size);
+  std::vector<uint64_t> samples(plan.channelNum(), 0);
+  uint64_t tick = 0;
+  uint32_t n = 0;
+  while (tick < total) {
+    // the size changes, but stays a multiple of the table like in scan mode
+    uint32_t count = L * (1 + (n++ % (buffer_size / L)));
+    if (count > total - tick) {
+      count = (uint32_t)(total - tick);
+    }
+    for (uint32_t i = 0; i < count; i++) {
+      buffer[i] = (uint16_t)(tick + i);
+    }
+    plan.demux(buffer.data(), (uint16_t)count, tick);
+    tick += count;
+
+    for (uint8_t c = 0; c < plan.channelNum(); c++) {
+      uint16_t sample;
+      while (plan.read(c, &sample, 1)) {
+        const uint16_t expected = (uint16_t)(plan.channelOffset(c) + samples[c]++ * plan.channelDivider(c));
+        if (sample != expected) {
+          if (errors < 10) {
+            printf("  channel %u: tick %u instead of %u\n", c, sample, expected);
+          }
+          errors++;
+        }
+      }
+      if (plan.droppedSamples(c)) {
+        printf("  channel %u: %u dropped\n", c, plan.droppedSamples(c));
+        errors++;
+      }
+    }
+  }
+  // every channel got all its samples
+  for (uint8_t c = 0; c < plan.channelNum(); c++) {
+    const uint64_t expected = (total > plan.channelOffset(c))
+                                  ? (total - plan.channelOffset(c) + plan.channelDivider(c) - 1) / plan.channelDivider(c)
+                                  : 0;
+    if (samples[c] != expected) {
+      printf("  channel %u: %llu samples instead of %llu\n", c, (unsigned long long)samples[c],
+             (unsigned long long)expected);
+      errors++;
+    }
+  }
+  return errors;
+}
+
+int main(int argc, char **argv) {
+  const uint32_t plans = (argc > 1) ? strtoul(argv[1], nullptr, 0) : 10000;
+  srand((argc > 2) ? strtoul(argv[2], nullptr, 0) : 1);
+  uint32_t errors = 0;
+
+  // the example: temperature, motor current and vibration
+  {
+    const uint8_t pins[] = {14, 15, 16};
+    const uint32_t rates[] = {10, 20000, 50000};
+    ADC_Scheduler plan;
+    for (uint8_t c = 0; c < 3; c++) {
+      plan.addChannel(pins[c], rates[c], ring[c], 4096);
+    }
+    if (!plan.build(400000)) {
+      printf("example: no plan\n");
+      return 1;
+    }
+    printPlan(plan);
+    errors += check(plan, pins, 3 * (uint64_t)plan.timerFrequency(), 500);
+  }
+
+  // random rates, from the fast channels of a table to slow ones
+  uint32_t built = 0;
+  for (uint32_t p = 0; p < plans; p++) {
+    ADC_Scheduler plan;
+    const uint8_t channel_num = 1 + rand() % ADC_SCHEDULER_MAX_CHANNELS;
+    const uint32_t base = 100 * (1 + rand() % 50);
+    uint8_t pins[ADC_SCHEDULER_MAX_CHANNELS];
+    for (uint8_t c = 0; c < channel_num; c++) {
+      static const uint32_t dividers[] = {1, 2, 3, 4, 5, 6, 8, 10, 12, 16, 20, 24, 32, 100, 1000};
+      const uint32_t divider = dividers[rand() % (sizeof(dividers) / sizeof(dividers[0]))];
+      pins[c] = c;
+      plan.addChannel(pins[c], base * 32 / divider, ring[c], 4096);
+    }
+    if (!plan.build(1000000)) {
+      continue;
+    }
+    built++;
+    // some slots must be left for the conversions
+    uint32_t used = 0;
+    for (uint8_t s = 0; s < plan.slotNum(); s++) {
+      used += (plan.slotChannel(s) != ADC_Scheduler::IDLE);
+    }
+    if (!used) {
+      printf("plan %u: no slots used\n", p);
+      errors++;
+    }
+    const uint32_t e = check(plan, pins, 200 * (uint64_t)plan.slotNum() + 70001, 496);
+    if (e) {
+      printf("plan %u:\n", p);
+      printPlan(plan);
+    }
+    errors += e;
+  }
+
+  printf("%u of %u random plans built, %u errors\n", built, plans, errors);
+  return errors ? 1 : 0;
+}
@@ -0,0 +1,92 @@
+/* Teensy 4.x, 3.x, LC ADC library
+ * https://github.com/pedvide/ADC
+ * Copyright (c) 2020 Pedro Villanueva
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* Decode a stream of AnalogBufferDMAStream frames, read from a file (a
+ * recording) or stdin (the serial port). See README.md.
+ *
+ * Usage: adc_stream_decode [--csv] [file]
+ *   Prints one line per frame, or with --csv one line per sample:
+ *   channel,sequence,time_s,sample
+ *   The statistics go to stderr, the exit code is 1 if there were missing
+ *   buffers or bytes that couldn't be decoded.
+ */
+
+#include "adc_stream_decoder.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+int main(int argc, char **argv) {
+  bool csv = false;
+  const char *path = nullptr;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--csv") == 0) {
+      csv = true;
+    } else if (argv[i][0] == '-' && argv[i][1] != '\0') {
+      fprintf(stderr, "Usage: %s [--csv] [file]\n", argv[0]);
+      return 2;
+    } else {
+      path = argv[i];
+    }
+  }
+
+  FILE *input = stdin;
+  if (path && strcmp(path, "-") != 0) {
+    input = fopen(path, "rb");
+    if (!input) {
+      perror(path);
+      return 2;
+    }
+  }
+
+  ADCStreamDecoder decoder([csv](const ADCStreamDecoder::Frame &frame) {
+    const ADC_StreamHeader &h = frame.header;
+    double time_s = h.timestamp_frequency ? (double)h.timestamp / h.timestamp_frequency : 0;
+    if (!csv) {
+      printf("channel %u sequence %" PRIu32 " time %.6f s: %u samples%s%s\n", h.channel, h.sequence, time_s, h.count,
+             (h.flags & ADC_STREAM_FLAG_SIGNED) ? " signed" : "",
+             (h.flags & ADC_STREAM_FLAG_OVERRUN) ? " (overrun before)" : "");
+      return;
+    }
+    for (int32_t sample : frame.samples) {
+      printf("%u,%" PRIu32 ",%.6f,%" PRId32 "\n", h.channel, h.sequence, time_s, sample);
+    }
+  });
+
+  uint8_t chunk[4096];
+  size_t size;
+  while ((size = fread(chunk, 1, sizeof(chunk), input)) > 0) {
+    decoder.feed(chunk, size);
+  }
+  decoder.finish();
+  if (input != stdin) {
+    fclose(input);
+  }
+
+  fprintf(stderr, "%" PRIu64 " frames, %" PRIu64 " missing buffers, %" PRIu64 " bytes skipped, %zu bytes incomplete\n",
+          decoder.frames(), decoder.missingBuffers(), decoder.skippedBytes(), decoder.pendingBytes());
+  return (decoder.missingBuffers() || decoder.skippedBytes()) ? 1 : 0;
+}
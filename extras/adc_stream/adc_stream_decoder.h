@@ -0,0 +1,188 @@
+/* Teensy 4.x, 3.x, LC ADC library
+ * https://github.com/pedvide/ADC
+ * Copyright (c) 2020 Pedro Villanueva
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* Host side decoder of the frames sent by AnalogBufferDMAStream.
+ * Feed it the bytes as they arrive (any chunk size), it calls the frame
+ * handler for each complete frame. Bytes that don't belong to a frame
+ * (a partial frame at the start of a recording, text printed to the same
+ * port, ...) are skipped until the next valid header.
+ * A header is valid if its version and size are known and its CRC matches
+ * (version 2), or its reserved bytes are 0 (version 1, without CRC).
+ * Call finish at the end of the data: a header whose samples go past the end
+ * is skipped then, so the frames after it are still decoded.
+ */
+
+#ifndef ADC_STREAM_DECODER_H
+#define ADC_STREAM_DECODER_H
+
+#include "../../ADC_stream.h"
+
+#include <functional>
+#include <map>
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+class ADCStreamDecoder {
+public:
+  //! A decoded frame, the samples are already sign extended if signed
+  struct Frame {
+    ADC_StreamHeader header;
+    std::vector<int32_t> samples;
+  };
+  typedef std::function<void(const Frame &)> FrameHandler;
+
+  explicit ADCStreamDecoder(FrameHandler handler) : handler(handler) {}
+
+  //! Decode the bytes, returns the number of complete frames in them
+  size_t feed(const uint8_t *data, size_t size) {
+    pending.insert(pending.end(), data, data + size);
+    return decode(false);
+  }
+
+  //! No more data, decode what's left and return the number of frames in it
+  size_t finish() { return decode(true); }
+
+  //! Frames decoded so far
+  uint64_t frames() const { return total_frames; }
+  //! Bytes that weren't part of a frame
+  uint64_t skippedBytes() const { return skipped; }
+  //! Buffers missing from the sequence numbers of all channels
+  uint64_t missingBuffers() const { return missing; }
+  //! Bytes of an incomplete frame at the end of the data
+  size_t pendingBytes() const { return pending.size(); }
+
+private:
+  static const size_t minimum_header = sizeof(ADC_StreamHeader);
+  // offset of header_crc
+  static const size_t crc_offset = 28;
+
+  static uint16_t le16(const uint8_t *p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+  static uint32_t le32(const uint8_t *p) { return le16(p) | ((uint32_t)le16(p + 2) << 16); }
+  static uint64_t le64(const uint8_t *p) { return le32(p) | ((uint64_t)le32(p + 4) << 32); }
+
+  // the fields of the header can't be checked until the whole header is there
+  static bool validHeader(const uint8_t *p) {
+    const uint8_t version = p[4];
+    const uint8_t header_size = p[7];
+    if ((version < 1) || (version > ADC_STREAM_VERSION) || (header_size < minimum_header) ||
+        (header_size > ADC_STREAM_MAX_HEADER_SIZE)) {
+      return false;
+    }
+    if (version == 1) {
+      return (header_size == minimum_header) && (le32(p + crc_offset) == 0);
+    }
+    uint16_t crc = adcStreamCRC16(p, crc_offset);
+    const uint8_t zero[2] = {0, 0};
+    crc = adcStreamCRC16(zero, 2, crc);
+    crc = adcStreamCRC16(p + crc_offset + 2, header_size - crc_offset - 2, crc);
+    return crc == le16(p + crc_offset);
+  }
+
+  // at the end a frame longer than the remaining bytes can't be one
+  size_t decode(bool end) {
+    size_t frames = 0;
+    size_t pos = 0;
+    while (true) {
+      // find the magic
+      size_t start = pos;
+      while ((pos + 4 <= pending.size()) && (le32(&pending[pos]) != ADC_STREAM_MAGIC)) {
+        pos++;
+      }
+      skipped += pos - start;
+      if ((pos + minimum_header > pending.size()) || (pos + pending[pos + 7] > pending.size())) {
+        if (end && (pos + 4 <= pending.size())) {
+          pos++; // a header cut by the end of the data
+          skipped++;
+          continue;
+        }
+        break; // wait for the rest of the header
+      }
+      const uint8_t *p = &pending[pos];
+      if (!validHeader(p)) {
+        pos++; // not a header, the magic was in the data
+        skipped++;
+        continue;
+      }
+      Frame frame;
+      ADC_StreamHeader &h = frame.header;
+      h.magic = le32(p);
+      h.version = p[4];
+      h.channel = p[5];
+      h.flags = p[6];
+      h.header_size = p[7];
+      h.sequence = le32(p + 8);
+      h.count = le16(p + 12);
+      h.interleave = le16(p + 14);
+      h.timestamp = le64(p + 16);
+      h.timestamp_frequency = le32(p + 24);
+      h.header_crc = le16(p + crc_offset);
+      h.reserved = le16(p + crc_offset + 2);
+      size_t frame_size = h.header_size + 2 * (size_t)h.count;
+      if (pos + frame_size > pending.size()) {
+        if (end) {
+          pos++; // the samples would go past the end, not a frame
+          skipped++;
+          continue;
+        }
+        break; // wait for the rest of the samples
+      }
+      const uint8_t *s = p + h.header_size;
+      frame.samples.resize(h.count);
+      for (size_t i = 0; i < h.count; i++) {
+        uint16_t value = le16(s + 2 * i);
+        frame.samples[i] = (h.flags & ADC_STREAM_FLAG_SIGNED) ? (int32_t)(int16_t)value : (int32_t)value;
+      }
+      checkSequence(h);
+      handler(frame);
+      frames++;
+      total_frames++;
+      pos += frame_size;
+    }
+    if (end) {
+      skipped += pending.size() - pos; // a magic cut by the end
+      pos = pending.size();
+    }
+    pending.erase(pending.begin(), pending.begin() + pos);
+    return frames;
+  }
+
+  void checkSequence(const ADC_StreamHeader &h) {
+    auto last = next_sequence.find(h.channel);
+    if ((last != next_sequence.end()) && (h.sequence > last->second)) {
+      missing += h.sequence - last->second;
+    }
+    next_sequence[h.channel] = h.sequence + 1;
+  }
+
+  FrameHandler handler;
+  std::vector<uint8_t> pending;
+  std::map<uint8_t, uint32_t> next_sequence;
+  uint64_t total_frames = 0;
+  uint64_t skipped = 0;
+  uint64_t missing = 0;
+};
+
+#endif // ADC_STREAM_DECODER_H
@@ -0,0 +1,185 @@
+/* Teensy 4.x, 3.x, LC ADC library
+ * https://github.com/pedvide/ADC
+ * Copyright (c) 2020 Pedro Villanueva
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* Decode capture.bin and check the result, see README.md.
+ *
+ * capture.bin is laid out like a recording of the adc_dma_stream example:
+ * text printed before the stream, the end of a frame cut by the start of the
+ * recording, frames of three channels (one of them version 1), a frame whose
+ * header was corrupted, samples containing the magic and a frame cut by the
+ * end of the recording.
+ *
+ * Usage: adc_stream_test [capture.bin]
+ *        adc_stream_test --write capture.bin   (regenerate it)
+ */
+
+#include "adc_stream_decoder.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static std::vector<uint8_t> frame(uint8_t version, uint8_t channel, uint8_t flags, uint32_t sequence,
+                                  const std::vector<uint16_t> &samples) {
+  ADC_StreamHeader header;
+  header.magic = ADC_STREAM_MAGIC;
+  header.version = version;
+  header.channel = channel;
+  header.flags = flags;
+  header.header_size = sizeof(header);
+  header.sequence = sequence;
+  header.count = samples.size();
+  header.interleave = 1;
+  header.timestamp = 1000 * (uint64_t)sequence;
+  header.timestamp_frequency = 1000000;
+  header.header_crc = 0;
+  header.reserved = 0;
+  if (version >= 2) {
+    header.header_crc = adcStreamCRC16((const uint8_t *)&header, sizeof(header));
+  }
+  std::vector<uint8_t> bytes((const uint8_t *)&header, (const uint8_t *)&header + sizeof(header));
+  bytes.insert(bytes.end(), (const uint8_t *)samples.data(), (const uint8_t *)(samples.data() + samples.size()));
+  return bytes;
+}
+
+static std::vector<uint16_t> ramp(uint16_t first, size_t count) {
+  std::vector<uint16_t> samples(count);
+  for (size_t i = 0; i < count; i++) {
+    samples[i] = first + i;
+  }
+  return samples;
+}
+
+static std::vector<uint8_t> capture() {
+  std::vector<uint8_t> data;
+  auto append = [&data](const std::vector<uint8_t> &bytes) { data.insert(data.end(), bytes.begin(), bytes.end()); };
+
+  const char text[] = "Streaming ADC0\r\n";
+  append(std::vector<uint8_t>(text, text + strlen(text)));
+  std::vector<uint8_t> cut = frame(2, 0, 0, 4, ramp(100, 16));
+  data.insert(data.end(), cut.end() - 20, cut.end());
+
+  // the magic ("ADCS") in the samples, followed by a header of a future version
+  std::vector<uint16_t> magic = ramp(200, 16);
+  magic[4] = 0x4441;
+  magic[5] = 0x5343;
+  magic[6] = 0x0303;
+  magic[7] = 0x2000;
+  append(frame(2, 0, 0, 5, magic));
+  append(frame(2, 0, 0, 6, ramp(300, 16)));
+  std::vector<uint8_t> corrupted = frame(2, 0, 0, 7, ramp(400, 16));
+  corrupted[17] ^= 0x10; // a bit of the timestamp
+  append(corrupted);
+  append(frame(2, 1, ADC_STREAM_FLAG_SIGNED, 0, {0xFFFF, 0xFF00, 0x0001, 0x8000}));
+  append(frame(1, 2, 0, 0, ramp(500, 8)));
+  append(frame(2, 0, ADC_STREAM_FLAG_OVERRUN, 8, ramp(600, 16)));
+  std::vector<uint8_t> truncated = frame(2, 0, 0, 9, ramp(700, 16));
+  data.insert(data.end(), truncated.begin(), truncated.begin() + 40);
+  return data;
+}
+
+static int failures = 0;
+
+static void check(bool condition, const char *what) {
+  if (!condition) {
+    fprintf(stderr, "FAIL: %s\n", what);
+    failures++;
+  }
+}
+
+// decode feeding chunk bytes at a time, the result can't depend on it
+static void decode(const std::vector<uint8_t> &data, size_t chunk) {
+  std::vector<ADCStreamDecoder::Frame> frames;
+  ADCStreamDecoder decoder([&frames](const ADCStreamDecoder::Frame &frame) { frames.push_back(frame); });
+  for (size_t pos = 0; pos < data.size(); pos += chunk) {
+    decoder.feed(&data[pos], std::min(chunk, data.size() - pos));
+  }
+  decoder.finish();
+
+  check(decoder.frames() == 5, "5 frames");
+  check(frames.size() == 5, "5 frames handled");
+  check(decoder.missingBuffers() == 1, "the corrupted frame is missing");
+  check(decoder.skippedBytes() == 16 + 20 + 64 + 40, "text, cut, corrupted and truncated frames skipped");
+  check(decoder.pendingBytes() == 0, "nothing pending after finish");
+  if (frames.size() != 5) {
+    return;
+  }
+  check((frames[0].header.sequence == 5) && (frames[0].samples[4] == 0x4441), "magic in the samples");
+  check((frames[1].header.sequence == 6) && (frames[1].samples[15] == 315), "second frame");
+  check((frames[2].header.channel == 1) && (frames[2].samples[0] == -1) && (frames[2].samples[3] == -32768),
+        "signed frame");
+  check((frames[3].header.version == 1) && (frames[3].samples[7] == 507), "version 1 frame");
+  check((frames[4].header.sequence == 8) && (frames[4].header.flags & ADC_STREAM_FLAG_OVERRUN), "overrun frame");
+}
+
+int main(int argc, char **argv) {
+  if ((argc == 3) && (strcmp(argv[1], "--write") == 0)) {
+    std::vector<uint8_t> data = capture();
+    FILE *output = fopen(argv[2], "wb");
+    if (!output || (fwrite(data.data(), 1, data.size(), output) != data.size())) {
+      perror(argv[2]);
+      return 2;
+    }
+    fclose(output);
+    return 0;
+  }
+
+  const char *path = (argc > 1) ? argv[1] : "capture.bin";
+  FILE *input = fopen(path, "rb");
+  if (!input) {
+    perror(path);
+    return 2;
+  }
+  std::vector<uint8_t> data;
+  uint8_t chunk[4096];
+  size_t size;
+  while ((size = fread(chunk, 1, sizeof(chunk), input)) > 0) {
+    data.insert(data.end(), chunk, chunk + size);
+  }
+  fclose(input);
+
+  check(data == capture(), "capture.bin matches the frame format");
+  for (size_t chunk_size : {(size_t)1, (size_t)7, (size_t)64, data.size()}) {
+    decode(data, chunk_size);
+  }
+  // corrupt every byte of a header in turn, that frame is lost but never the next
+  for (size_t i = 0; i < sizeof(ADC_StreamHeader); i++) {
+    std::vector<uint8_t> corrupted = data;
+    corrupted[36 + 64 + i] ^= 0x01; // header of sequence 6
+    std::vector<uint32_t> sequences;
+    ADCStreamDecoder decoder([&sequences](const ADCStreamDecoder::Frame &frame) {
+      sequences.push_back(frame.header.sequence);
+    });
+    decoder.feed(corrupted.data(), corrupted.size());
+    decoder.finish();
+    check((sequences.size() == 4) && (sequences[0] == 5) && (sequences[1] == 0), "resync after a corrupted header");
+  }
+
+  if (failures) {
+    fprintf(stderr, "%d checks failed\n", failures);
+    return 1;
+  }
+  printf("all checks passed\n");
+  return 0;
+}
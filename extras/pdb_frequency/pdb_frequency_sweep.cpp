@@ -0,0 +1,179 @@
+/* Teensy 4.x, 3.x, LC ADC library
+ * https://github.com/pedvide/ADC
+ * Copyright (c) 2020 Pedro Villanueva
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* Checks the PDB frequency solver of ADC_pdb.h on a computer.
+ * For each bus frequency of the Teensy 3.x boards it sweeps 1 Hz to F_BUS:
+ * every frequency up to 200 kHz and then 2000 per decade. It checks that
+ * the setting fits in the registers and compares its error with the old
+ * solver (an if-ladder of prescaler and mult and a truncated mod). For some
+ * of the frequencies it also searches all the settings to check that the
+ * error is the minimum. See README.md.
+ *
+ * Usage: pdb_frequency_sweep [f_bus ...]
+ */
+
+#include "../../ADC_pdb.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// the solver in startPDB before ADC_pdb
+static ADC_pdb::Setting oldSolver(uint32_t f_bus, uint32_t freq) {
+  uint32_t mod = f_bus / freq;
+  uint8_t prescaler = 0;
+  uint8_t mult = 0;
+  const uint32_t m = 0xFFFF;
+  static const struct {
+    uint32_t limit;
+    uint8_t prescaler, mult;
+  } ladder[] = {{2, 1, 0},    {4, 2, 0},    {8, 3, 0},     {10, 0, 1},   {16, 4, 0},
+                {20, 0, 2},   {32, 5, 0},   {40, 0, 3},    {64, 6, 0},   {128, 7, 0},
+                {160, 4, 1},  {320, 4, 2},  {640, 4, 3},   {1280, 5, 3}, {2560, 6, 3},
+                {5120, 7, 3}};
+  if (mod > m) {
+    for (const auto &step : ladder) {
+      if (mod < step.limit * m) {
+        prescaler = step.prescaler;
+        mult = step.mult;
+        break;
+      }
+    }
+    mod >>= prescaler;
+    if (mult > 0) {
+      mod /= 10;
+      mod >>= (mult - 1);
+    }
+  }
+  return {prescaler, mult, mod};
+}
+
+// all the settings
+static double bruteForceError(uint32_t f_bus, uint32_t freq) {
+  double best = -1;
+  for (uint8_t prescaler = 0; prescaler < 8; prescaler++) {
+    for (uint8_t mult = 0; mult < 4; mult++) {
+      for (uint32_t mod = 1; mod <= ADC_pdb::max_mod; mod++) {
+        double error = fabs(ADC_pdb::frequency(f_bus, {prescaler, mult, mod}) - freq);
+        if ((best < 0) || (error < best)) {
+          best = error;
+        }
+      }
+    }
+  }
+  return best;
+}
+
+struct Stats {
+  uint64_t checked = 0;
+  uint64_t failures = 0;
+  uint64_t better = 0; // smaller error than the old solver
+  uint64_t worse = 0;
+  double worst_relative = 0;
+  uint32_t worst_freq = 0;
+  double old_worst_relative = 0;
+  uint32_t old_worst_freq = 0;
+};
+
+static void check(uint32_t f_bus, uint32_t freq, bool brute_force, Stats &stats) {
+  stats.checked++;
+  ADC_pdb::Setting setting = {};
+  if (!ADC_pdb::solve(f_bus, freq, &setting) || (setting.prescaler > 7) || (setting.mult > 3) ||
+      (setting.mod == 0) || (setting.mod > ADC_pdb::max_mod)) {
+    printf("  %u Hz: no valid setting\n", freq);
+    stats.failures++;
+    return;
+  }
+  const double error = fabs(ADC_pdb::frequency(f_bus, setting) - freq);
+  if (error / freq > stats.worst_relative) {
+    stats.worst_relative = error / freq;
+    stats.worst_freq = freq;
+  }
+
+  ADC_pdb::Setting old_setting = oldSolver(f_bus, freq);
+  if ((old_setting.mod > 0) && (old_setting.mod <= ADC_pdb::max_mod)) {
+    const double old_error = fabs(ADC_pdb::frequency(f_bus, old_setting) - freq);
+    if (old_error / freq > stats.old_worst_relative) {
+      stats.old_worst_relative = old_error / freq;
+      stats.old_worst_freq = freq;
+    }
+    if (error < old_error * (1 - 1e-12)) {
+      stats.better++;
+    } else if (error > old_error * (1 + 1e-12)) {
+      printf("  %u Hz: error %g Hz, the old solver had %g Hz\n", freq, error, old_error);
+      stats.worse++;
+      stats.failures++;
+    }
+  }
+
+  if (brute_force) {
+    const double best = bruteForceError(f_bus, freq);
+    if (error > best * (1 + 1e-12)) {
+      printf("  %u Hz: error %g Hz, the best is %g Hz\n", freq, error, best);
+      stats.failures++;
+    }
+  }
+}
+
+int main(int argc, char **argv) {
+  static const uint32_t default_buses[] = {24000000, 36000000, 48000000, 60000000};
+  const int bus_num = (argc > 1) ? argc - 1 : 4;
+
+  uint64_t failures = 0;
+  for (int b = 0; b < bus_num; b++) {
+    const uint32_t f_bus = (argc > 1) ? strtoul(argv[b + 1], nullptr, 0) : default_buses[b];
+    printf("F_BUS %u Hz\n", f_bus);
+    Stats stats;
+    uint32_t freq = 1;
+    for (; (freq <= 200000) && (freq <= f_bus); freq++) {
+      check(f_bus, freq, (freq % 9973) == 0, stats);
+    }
+    for (double f = freq; f <= f_bus; f *= pow(10, 1.0 / 2000)) {
+      check(f_bus, (uint32_t)f, false, stats);
+    }
+    check(f_bus, f_bus, false, stats);
+    // some audio rates and a fast one, with what the old solver gave
+    static const uint32_t rates[] = {8000, 11025, 22050, 44100, 48000, 96000, 12009700};
+    for (uint32_t rate : rates) {
+      ADC_pdb::Setting setting = {};
+      ADC_pdb::solve(f_bus, rate, &setting);
+      printf("  %u Hz -> %.4f Hz (prescaler %u, mult %u, mod %u), old solver %.4f Hz\n", rate,
+             ADC_pdb::frequency(f_bus, setting), setting.prescaler, setting.mult, setting.mod,
+             ADC_pdb::frequency(f_bus, oldSolver(f_bus, rate)));
+    }
+    // out of range
+    ADC_pdb::Setting setting = {};
+    if (ADC_pdb::solve(f_bus, 0, &setting) || ADC_pdb::solve(f_bus, f_bus + 1, &setting)) {
+      printf("  out of range frequencies accepted\n");
+      stats.failures++;
+    }
+    printf("  %llu frequencies, %llu failures, %llu better than the old solver\n",
+           (unsigned long long)stats.checked, (unsigned long long)stats.failures, (unsigned long long)stats.better);
+    printf("  worst relative error %.3g at %u Hz (old solver %.3g at %u Hz)\n", stats.worst_relative,
+           stats.worst_freq, stats.old_worst_relative, stats.old_worst_freq);
+    failures += stats.failures;
+  }
+  return failures ? 1 : 0;
+}
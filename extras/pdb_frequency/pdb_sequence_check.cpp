@@ -0,0 +1,146 @@
+/* Teensy 4.x, 3.x, LC ADC library
+ * https://github.com/pedvide/ADC
+ * Copyright (c) 2020 Pedro Villanueva
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* Checks the pretrigger sequences of ADC_pdb.h on a computer: the registers
+ * of a power meter sequence, the rejected sequences, and for many random
+ * periods and delays that the delay is rounded to the nearest PDB count and
+ * that the sequence is rejected exactly when it doesn't fit in the period.
+ * See README.md.
+ *
+ * Usage: pdb_sequence_check [f_bus]
+ */
+
+#include "../../ADC_pdb.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+static uint32_t failures = 0;
+
+static void expect(bool ok, const char *what) {
+  if (!ok) {
+    printf("FAILED: %s\n", what);
+    failures++;
+  }
+}
+
+int main(int argc, char **argv) {
+  const uint32_t f_bus = (argc > 1) ? strtoul(argv[1], nullptr, 0) : 60000000;
+  ADC_pdb::SequenceRegisters regs;
+
+  // 128 samples per 60 Hz cycle of two voltages and two currents: each ADC
+  // converts a voltage and a current at the same time as the other one
+  {
+    const uint32_t freq = 60 * 128;
+    ADC_pdb::Setting setting = {};
+    ADC_pdb::solve(f_bus, freq, &setting);
+    ADC_pdb::Sequence sequence;
+    expect(sequence.add(0, 0, 14, 0) == 0, "add voltage A");
+    expect(sequence.add(1, 0, 15, 0) == 1, "add voltage B");
+    expect(sequence.add(0, 1, 16, 20000) == 2, "add current A");
+    expect(sequence.add(1, 1, 17, 20000) == 3, "add current B");
+    expect(sequence.add(1, 1, 18, 0) == -1, "only four steps");
+    expect(sequence.compile(f_bus, setting, 2, &regs), "compile");
+    const uint32_t ticks = ADC_pdb::Sequence::delayTicks(f_bus, setting, 20000);
+    expect((regs.c1[0] == 0x303) && (regs.c1[1] == 0x303), "CHnC1: TOS and EN of both pretriggers");
+    expect((regs.dly[0][0] == 0) && (regs.dly[1][0] == 0), "CHnDLY0");
+    expect((regs.dly[0][1] == ticks) && (regs.dly[1][1] == ticks), "CHnDLY1");
+    printf("%u Hz: prescaler %u, mult %u, mod %u, 20 us is %u counts (%.1f ns)\n", freq, setting.prescaler,
+           setting.mult, setting.mod, ticks, sequence.delayNs(f_bus, setting, 2));
+
+    // both ADCs need the whole ring
+    expect(!sequence.compile(f_bus, setting, 1, &regs), "ADC1 on a board with one ADC");
+  }
+
+  // back to back
+  {
+    ADC_pdb::Setting setting = {0, 0, 6000}; // 10 kHz at 60 MHz
+    ADC_pdb::Sequence sequence;
+    sequence.add(0, 0, 14, 1000);
+    sequence.addBackToBack(0, 1, 15);
+    sequence.addBackToBack(1, 0, 16);
+    sequence.addBackToBack(1, 1, 17);
+    expect(sequence.compile(f_bus, setting, 2, &regs), "ring of back to back conversions");
+    expect((regs.c1[0] == 0x20103) && (regs.c1[1] == 0x30003), "CHnC1: BB and EN");
+
+    ADC_pdb::Sequence no_previous;
+    no_previous.add(0, 0, 14, 0);
+    no_previous.addBackToBack(1, 0, 15);
+    expect(!no_previous.compile(f_bus, setting, 2, &regs), "back to back after a missing pretrigger");
+
+    ADC_pdb::Sequence single;
+    single.add(0, 1, 14, 100);
+    single.addBackToBack(0, 0, 15);
+    expect(!single.compile(f_bus, setting, 1, &regs), "back to back pretrigger 0 with one ADC");
+
+    ADC_pdb::Sequence loop;
+    loop.addBackToBack(0, 0, 14);
+    loop.addBackToBack(0, 1, 15);
+    loop.addBackToBack(1, 0, 16);
+    loop.addBackToBack(1, 1, 17);
+    expect(!loop.compile(f_bus, setting, 2, &regs), "only back to back");
+
+    ADC_pdb::Sequence duplicate;
+    duplicate.add(0, 0, 14, 0);
+    expect(duplicate.add(0, 0, 15, 10) == -1, "the same pretrigger twice");
+    expect(duplicate.add(2, 0, 15, 10) == -1, "ADC 2");
+    expect(duplicate.add(0, 2, 15, 10) == -1, "pretrigger 2");
+  }
+
+  // random periods and delays
+  srand(1);
+  uint32_t compiled = 0;
+  const uint32_t tries = 1000000;
+  for (uint32_t i = 0; i < tries; i++) {
+    const uint32_t freq = 1 + rand() % 200000;
+    ADC_pdb::Setting setting = {};
+    ADC_pdb::solve(f_bus, freq, &setting);
+    const double tick_ns = 1e9 * ADC_pdb::divider(setting.prescaler, setting.mult) / f_bus;
+    const uint32_t delay_ns = (uint32_t)(((uint64_t)rand() * rand()) % (uint64_t)(1.2e9 / freq + 1));
+    ADC_pdb::Sequence sequence;
+    sequence.add(0, 0, 14, 0);
+    sequence.add(1, 0, 15, delay_ns);
+    const bool ok = sequence.compile(f_bus, setting, 2, &regs);
+    const uint32_t ticks = ADC_pdb::Sequence::delayTicks(f_bus, setting, delay_ns);
+    if (ok != (ticks < setting.mod)) {
+      printf("FAILED: %u Hz, delay %u ns compiled %d with %u counts of %u\n", freq, delay_ns, ok, ticks, setting.mod);
+      failures++;
+    }
+    if (fabs(sequence.delayNs(f_bus, setting, 1) - delay_ns) > tick_ns / 2 + 1e-6) {
+      printf("FAILED: %u Hz, delay %u ns is %.1f ns\n", freq, delay_ns, sequence.delayNs(f_bus, setting, 1));
+      failures++;
+    }
+    if (ok) {
+      compiled++;
+      if (regs.dly[1][0] != ticks) {
+        printf("FAILED: %u Hz, delay %u ns in CH1DLY0 is %u\n", freq, delay_ns, regs.dly[1][0]);
+        failures++;
+      }
+    }
+  }
+  printf("%u of %u random sequences fit in the period, %u failures\n", compiled, tries, failures);
+  return failures ? 1 : 0;
+}
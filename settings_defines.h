@@ -671,6 +671,7 @@ enum class ADC_ERROR : uint16_t {
   COMPARISON = 1 << 7, /*!< Error during the comparison. */
   WRONG_ADC = 1 << 8,  /*!< A non-existent ADC module was selected. */
   SYNCH = 1 << 9,      /*!< Error during a synchronized measurement. */
+  DMA = 1 << 10,       /*!< Error setting up a DMA buffer. */
 
   CLEAR = 0, /*!< No error. */
 };